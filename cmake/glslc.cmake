@@ -1,2 +1,32 @@
 find_program(GLSLC_EXE NAMES glslc REQUIRED)
 message(STATUS "glslc found: ${GLSLC_EXE}")
+
+# Compiles SHADER to ${NAME}.spv and to ${NAME}.spv.inc in the current binary
+# directory. The latter holds the same SPIR-V as comma separated numbers,
+# ready to be included into an initializer of a uint32_t array.
+function(compile_shader TARGET SHADER NAME)
+    set(SPIRV ${CMAKE_CURRENT_BINARY_DIR}/${NAME}.spv)
+
+    add_custom_command(
+        OUTPUT ${SPIRV}
+        COMMAND
+            ${GLSLC_EXE} ${SHADER} -o ${SPIRV}
+        DEPENDS
+            ${SHADER}
+    )
+
+    add_custom_command(
+        OUTPUT ${SPIRV}.inc
+        COMMAND
+            ${GLSLC_EXE} -mfmt=num ${SHADER} -o ${SPIRV}.inc
+        DEPENDS
+            ${SHADER}
+    )
+
+    target_sources(${TARGET}
+        PRIVATE
+            ${SHADER}
+            ${SPIRV}
+            ${SPIRV}.inc
+    )
+endfunction()
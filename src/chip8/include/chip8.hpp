@@ -1,12 +1,13 @@
 #ifndef VKCHIP8_CHIP8_INCLUDED
 #define VKCHIP8_CHIP8_INCLUDED
 
+#include <random_engine.hpp>
+
 #include <array>
 #include <bitset>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
-#include <random>
 #include <span>
 #include <vector>
 
@@ -47,12 +48,36 @@ namespace vkchip8
         static constexpr size_t memory_size{4096};
         static constexpr uint16_t start_address{0x200};
 
+    public: // Types
+        using screen_rows =
+            std::array<std::bitset<screen_width>, screen_height>;
+
+        // Complete emulated machine state, copy it to take a save state.
+        struct [[nodiscard]] state final
+        {
+            std::vector<std::byte> memory;
+            uint16_t program_counter{start_address};
+            std::array<uint8_t, 16> data_registers{};
+            uint16_t i_register{};
+            uint8_t sound_timer{};
+            uint8_t delay_timer{};
+            screen_rows screen{};
+            std::array<uint16_t, stack_size> stack{};
+            size_t stack_pointer{};
+            std::bitset<16> keys{};
+            random_engine random;
+            uint64_t cycle{};
+            uint64_t frame{};
+
+            bool operator==(state const&) const = default;
+        };
+
     public: // Construction
         chip8() : chip8{memory_size} { }
 
         explicit chip8(
             size_t ram_size,
-            uint_fast32_t random_seed = {},
+            random_engine random = {},
             std::function<void(void)> beep_callback = []() {});
 
         chip8(chip8 const&) = default;
@@ -71,13 +96,17 @@ namespace vkchip8
         void load(std::span<std::byte const> program,
             uint16_t address = start_address);
 
-        [[nodiscard]] std::array<std::bitset<screen_width>,
-            screen_height> const&
-        screen_data() const
+        [[nodiscard]] screen_rows const& screen_data() const
         {
-            return screen_;
+            return state_.screen;
         }
 
+        [[nodiscard]] state const& current_state() const { return state_; }
+
+        // Reuses already allocated memory, cheap enough to be done several
+        // times per frame
+        void restore_state(state const& saved);
+
     public: // Operators
         chip8& operator=(chip8 const&) = default;
         chip8& operator=(chip8&&) noexcept = default;
@@ -92,18 +121,7 @@ namespace vkchip8
         [[nodiscard]] uint16_t pop_stack();
 
     private: // Data
-        std::vector<std::byte> memory_;
-        uint16_t program_counter_{start_address};
-        std::array<uint8_t, 16> data_registers_{};
-        uint16_t i_register_{};
-        uint8_t sound_timer_{};
-        uint8_t delay_timer_{};
-        std::array<std::bitset<screen_width>, screen_height> screen_{};
-        std::array<uint16_t, stack_size> stack_{};
-        size_t stack_pointer_{};
-        std::bitset<16> keys_{};
-
-        std::minstd_rand random_engine_;
+        state state_;
         std::function<void(void)> beep_callback_;
     };
 } // namespace vkchip8
@@ -0,0 +1,137 @@
+#ifndef VKCHIP8_INPUT_MOVIE_INCLUDED
+#define VKCHIP8_INPUT_MOVIE_INCLUDED
+
+#include <chip8.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+namespace vkchip8
+{
+    struct [[nodiscard]] movie_event final
+    {
+        uint64_t frame{};
+        uint64_t cycle{};
+        key_event_type type{};
+        key_code code{};
+
+        bool operator==(movie_event const&) const = default;
+    };
+
+    // Key events stamped with the emulated frame and cycle on which they were
+    // applied. State of the emulator is stored every keyframe_interval frames.
+    class [[nodiscard]] input_movie final
+    {
+    public: // Construction
+        input_movie(chip8 const& emulator,
+            uint64_t seed,
+            uint32_t cycles_per_frame,
+            uint32_t keyframe_interval);
+
+        input_movie(input_movie const&) = default;
+
+        input_movie(input_movie&&) noexcept = default;
+
+    public: // Destruction
+        ~input_movie() = default;
+
+    public: // Interface
+        void record_event(chip8 const& emulator,
+            key_event_type type,
+            key_code code);
+
+        // Call after each emulated frame
+        void record_frame(chip8 const& emulator);
+
+        [[nodiscard]] constexpr uint64_t seed() const noexcept;
+
+        [[nodiscard]] constexpr uint32_t cycles_per_frame() const noexcept;
+
+        [[nodiscard]] constexpr uint32_t keyframe_interval() const noexcept;
+
+        [[nodiscard]] uint64_t first_frame() const;
+
+        [[nodiscard]] uint64_t last_frame() const;
+
+        [[nodiscard]] std::span<movie_event const> events() const;
+
+        [[nodiscard]] chip8::state const& keyframe_for(uint64_t frame) const;
+
+        void save(std::ostream& stream) const;
+
+        [[nodiscard]] static input_movie load(std::istream& stream);
+
+    public: // Operators
+        input_movie& operator=(input_movie const&) = default;
+
+        input_movie& operator=(input_movie&&) noexcept = default;
+
+    private: // Construction
+        input_movie() = default;
+
+    private: // Data
+        uint64_t seed_{};
+        uint32_t cycles_per_frame_{};
+        uint32_t keyframe_interval_{};
+        uint64_t last_frame_{};
+        std::vector<movie_event> events_;
+        std::vector<chip8::state> keyframes_;
+    };
+
+    class [[nodiscard]] movie_player final
+    {
+    public: // Construction
+        movie_player(input_movie const* movie, chip8* emulator);
+
+        movie_player(movie_player const&) = default;
+
+        movie_player(movie_player&&) noexcept = default;
+
+    public: // Destruction
+        ~movie_player() = default;
+
+    public: // Interface
+        void run_frame();
+
+        // Restores the closest keyframe and runs at most keyframe_interval
+        // frames to reach the requested one
+        void seek(uint64_t frame);
+
+        [[nodiscard]] bool finished() const;
+
+    public: // Operators
+        movie_player& operator=(movie_player const&) = default;
+
+        movie_player& operator=(movie_player&&) noexcept = default;
+
+    private: // Helpers
+        void apply_pending_events();
+
+    private: // Data
+        input_movie const* movie_{};
+        chip8* emulator_{};
+        size_t next_event_{};
+    };
+} // namespace vkchip8
+
+inline constexpr uint64_t vkchip8::input_movie::seed() const noexcept
+{
+    return seed_;
+}
+
+inline constexpr uint32_t
+vkchip8::input_movie::cycles_per_frame() const noexcept
+{
+    return cycles_per_frame_;
+}
+
+inline constexpr uint32_t
+vkchip8::input_movie::keyframe_interval() const noexcept
+{
+    return keyframe_interval_;
+}
+
+#endif // !VKCHIP8_INPUT_MOVIE_INCLUDED
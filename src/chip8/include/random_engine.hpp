@@ -0,0 +1,139 @@
+#ifndef VKCHIP8_RANDOM_ENGINE_INCLUDED
+#define VKCHIP8_RANDOM_ENGINE_INCLUDED
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace vkchip8
+{
+    // PCG32 (XSH-RR 64/32) generator. Output is fully defined by seed and
+    // stream, independent of the standard library implementation.
+    class [[nodiscard]] random_engine final
+    {
+    public: // Types
+        using result_type = uint32_t;
+
+    public: // Construction
+        constexpr random_engine() noexcept : random_engine{0} { }
+
+        constexpr explicit random_engine(uint64_t seed,
+            uint64_t stream = 0) noexcept;
+
+        random_engine(random_engine const&) = default;
+
+        random_engine(random_engine&&) noexcept = default;
+
+    public: // Destruction
+        ~random_engine() = default;
+
+    public: // Interface
+        // Seed splitting scheme for running multiple instances from a single
+        // seed, each instance gets its own stream of the generator.
+        [[nodiscard]] static constexpr random_engine for_instance(
+            uint64_t seed,
+            uint64_t instance) noexcept;
+
+        [[nodiscard]] static constexpr random_engine
+        from_state(uint64_t state, uint64_t increment) noexcept;
+
+        [[nodiscard]] static constexpr result_type min() noexcept;
+
+        [[nodiscard]] static constexpr result_type max() noexcept;
+
+        [[nodiscard]] constexpr result_type operator()() noexcept;
+
+        [[nodiscard]] constexpr uint8_t next_byte() noexcept;
+
+        [[nodiscard]] constexpr uint64_t state() const noexcept;
+
+        [[nodiscard]] constexpr uint64_t increment() const noexcept;
+
+    public: // Operators
+        random_engine& operator=(random_engine const&) = default;
+
+        random_engine& operator=(random_engine&&) noexcept = default;
+
+        constexpr bool operator==(random_engine const&) const = default;
+
+    private: // Constants
+        static constexpr uint64_t multiplier{6364136223846793005ULL};
+
+    private: // Data
+        uint64_t state_{};
+        uint64_t increment_{};
+    };
+} // namespace vkchip8
+
+inline constexpr vkchip8::random_engine::random_engine(uint64_t const seed,
+    uint64_t const stream) noexcept
+    : increment_{(stream << 1) | 1}
+{
+    static_cast<void>(operator()());
+    state_ += seed;
+    static_cast<void>(operator()());
+}
+
+inline constexpr vkchip8::random_engine vkchip8::random_engine::for_instance(
+    uint64_t const seed,
+    uint64_t const instance) noexcept
+{
+    // SplitMix64 finalizer decorrelates seeds of neighbouring instances
+    uint64_t mixed{seed + (instance + 1) * 0x9E37'79B9'7F4A'7C15ULL};
+    mixed = (mixed ^ (mixed >> 30)) * 0xBF58'476D'1CE4'E5B9ULL;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94D0'49BB'1331'11EBULL;
+    mixed ^= mixed >> 31;
+
+    return random_engine{mixed, instance};
+}
+
+inline constexpr vkchip8::random_engine vkchip8::random_engine::from_state(
+    uint64_t const state,
+    uint64_t const increment) noexcept
+{
+    random_engine rv;
+    rv.state_ = state;
+    rv.increment_ = increment | 1;
+    return rv;
+}
+
+inline constexpr vkchip8::random_engine::result_type
+vkchip8::random_engine::min() noexcept
+{
+    return std::numeric_limits<result_type>::min();
+}
+
+inline constexpr vkchip8::random_engine::result_type
+vkchip8::random_engine::max() noexcept
+{
+    return std::numeric_limits<result_type>::max();
+}
+
+inline constexpr vkchip8::random_engine::result_type
+vkchip8::random_engine::operator()() noexcept
+{
+    uint64_t const old_state{state_};
+    state_ = old_state * multiplier + increment_;
+
+    auto const xorshifted{
+        static_cast<uint32_t>(((old_state >> 18) ^ old_state) >> 27)};
+    auto const rotation{static_cast<int>(old_state >> 59)};
+    return std::rotr(xorshifted, rotation);
+}
+
+inline constexpr uint8_t vkchip8::random_engine::next_byte() noexcept
+{
+    return static_cast<uint8_t>(operator()() >> 24);
+}
+
+inline constexpr uint64_t vkchip8::random_engine::state() const noexcept
+{
+    return state_;
+}
+
+inline constexpr uint64_t vkchip8::random_engine::increment() const noexcept
+{
+    return increment_;
+}
+
+#endif // !VKCHIP8_RANDOM_ENGINE_INCLUDED
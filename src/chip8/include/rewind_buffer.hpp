@@ -0,0 +1,86 @@
+#ifndef VKCHIP8_REWIND_BUFFER_INCLUDED
+#define VKCHIP8_REWIND_BUFFER_INCLUDED
+
+#include <chip8.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vkchip8
+{
+    // Ring of emulator snapshots stored in a fixed size arena. Every
+    // keyframe_interval snapshots a full packed state is stored, others are
+    // stored as a run length encoded XOR against the last keyframe. Oldest
+    // snapshots are dropped when either the arena or the snapshot count limit
+    // is reached.
+    class [[nodiscard]] rewind_buffer final
+    {
+    public: // Construction
+        rewind_buffer(size_t max_snapshots,
+            size_t arena_size,
+            uint32_t keyframe_interval);
+
+        rewind_buffer(rewind_buffer const&) = default;
+
+        rewind_buffer(rewind_buffer&&) noexcept = default;
+
+    public: // Destruction
+        ~rewind_buffer() = default;
+
+    public: // Interface
+        void push(chip8::state const& state);
+
+        // Removes the newest snapshot and decodes it to state
+        [[nodiscard]] bool pop(chip8::state& state);
+
+        void clear();
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] size_t used_bytes() const;
+
+        [[nodiscard]] size_t arena_size() const;
+
+    public: // Operators
+        rewind_buffer& operator=(rewind_buffer const&) = default;
+
+        rewind_buffer& operator=(rewind_buffer&&) noexcept = default;
+
+    private: // Types
+        struct [[nodiscard]] entry final
+        {
+            size_t offset{};
+            size_t size{};
+            uint64_t keyframe{};
+            bool is_keyframe{};
+        };
+
+    private: // Helpers
+        [[nodiscard]] entry& at(uint64_t sequence);
+
+        [[nodiscard]] size_t allocate(size_t size);
+
+        void evict_oldest();
+
+    private: // Data
+        std::vector<entry> entries_;
+        size_t first_{};
+        size_t count_{};
+        uint64_t first_sequence_{};
+
+        std::vector<std::byte> arena_;
+        size_t head_{};
+        size_t used_bytes_{};
+
+        uint32_t keyframe_interval_{};
+        uint32_t since_keyframe_{};
+        uint64_t keyframe_sequence_{};
+
+        std::vector<std::byte> image_;
+        std::vector<std::byte> keyframe_image_;
+        std::vector<std::byte> delta_;
+    };
+} // namespace vkchip8
+
+#endif // !VKCHIP8_REWIND_BUFFER_INCLUDED
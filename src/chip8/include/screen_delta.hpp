@@ -0,0 +1,134 @@
+#ifndef VKCHIP8_SCREEN_DELTA_INCLUDED
+#define VKCHIP8_SCREEN_DELTA_INCLUDED
+
+#include <chip8.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace vkchip8
+{
+    // FNV-1a of the little endian bytes of every row, top to bottom
+    [[nodiscard]] uint64_t screen_hash(chip8::screen_rows const& screen);
+
+    // Writes one record per frame encoded against the previous frame, the
+    // first frame is encoded against a blank screen. A record is a little
+    // endian uint32 mask of changed rows, the uint64 XOR of each changed row
+    // in ascending order and the uint64 hash of the resulting screen, so an
+    // unchanged frame takes 12 bytes. Records are buffered, flush() or the
+    // destructor writes them to the stream.
+    class [[nodiscard]] screen_delta_writer final
+    {
+    public: // Construction
+        explicit screen_delta_writer(std::ostream* stream,
+            size_t buffer_size = 4096);
+
+        screen_delta_writer(screen_delta_writer const&) = delete;
+
+        screen_delta_writer(screen_delta_writer&&) noexcept = delete;
+
+    public: // Destruction
+        // Write failures are ignored, call flush() to detect them
+        ~screen_delta_writer();
+
+    public: // Interface
+        void write(chip8::screen_rows const& screen);
+
+        void flush();
+
+        [[nodiscard]] constexpr uint64_t frames() const noexcept;
+
+    public: // Operators
+        screen_delta_writer& operator=(screen_delta_writer const&) = delete;
+
+        screen_delta_writer& operator=(
+            screen_delta_writer&&) noexcept = delete;
+
+    private: // Helpers
+        void write_buffer();
+
+    private: // Data
+        std::ostream* stream_;
+        std::vector<std::byte> buffer_;
+        size_t used_{};
+        chip8::screen_rows previous_{};
+        uint64_t frames_{};
+    };
+
+    // Reconstructs the frames written by screen_delta_writer in order
+    class [[nodiscard]] screen_delta_reader final
+    {
+    public: // Construction
+        explicit screen_delta_reader(std::istream* stream);
+
+        screen_delta_reader(screen_delta_reader const&) = delete;
+
+        screen_delta_reader(screen_delta_reader&&) noexcept = delete;
+
+    public: // Destruction
+        ~screen_delta_reader() = default;
+
+    public: // Interface
+        // Decodes the next frame, returns false at the end of the stream.
+        // Truncated records and hash mismatches throw.
+        [[nodiscard]] bool next();
+
+        // Decodes frames until frame, counted from zero, is the current one.
+        // Returns false if it was already passed or the stream ends first.
+        [[nodiscard]] bool seek(uint64_t frame);
+
+        [[nodiscard]] constexpr chip8::screen_rows const&
+        screen() const noexcept;
+
+        [[nodiscard]] constexpr uint64_t hash() const noexcept;
+
+        // Number of decoded frames
+        [[nodiscard]] constexpr uint64_t frames() const noexcept;
+
+        // Whether the last decoded frame didn't change any row
+        [[nodiscard]] constexpr bool unchanged() const noexcept;
+
+    public: // Operators
+        screen_delta_reader& operator=(screen_delta_reader const&) = delete;
+
+        screen_delta_reader& operator=(
+            screen_delta_reader&&) noexcept = delete;
+
+    private: // Data
+        std::istream* stream_;
+        chip8::screen_rows screen_{};
+        uint64_t hash_{};
+        uint64_t frames_{};
+        bool unchanged_{};
+    };
+} // namespace vkchip8
+
+inline constexpr uint64_t vkchip8::screen_delta_writer::frames() const noexcept
+{
+    return frames_;
+}
+
+inline constexpr vkchip8::chip8::screen_rows const&
+vkchip8::screen_delta_reader::screen() const noexcept
+{
+    return screen_;
+}
+
+inline constexpr uint64_t vkchip8::screen_delta_reader::hash() const noexcept
+{
+    return hash_;
+}
+
+inline constexpr uint64_t vkchip8::screen_delta_reader::frames() const noexcept
+{
+    return frames_;
+}
+
+inline constexpr bool vkchip8::screen_delta_reader::unchanged() const noexcept
+{
+    return unchanged_;
+}
+
+#endif // !VKCHIP8_SCREEN_DELTA_INCLUDED
@@ -0,0 +1,20 @@
+#ifndef VKCHIP8_STATE_SERIALIZATION_INCLUDED
+#define VKCHIP8_STATE_SERIALIZATION_INCLUDED
+
+#include <chip8.hpp>
+
+#include <cstddef>
+#include <span>
+
+namespace vkchip8
+{
+    // Packed state is a little endian byte image with a layout which depends
+    // only on the size of emulated memory.
+    [[nodiscard]] size_t packed_size(chip8::state const& state);
+
+    void pack(chip8::state const& state, std::span<std::byte> buffer);
+
+    void unpack(std::span<std::byte const> buffer, chip8::state& state);
+} // namespace vkchip8
+
+#endif // !VKCHIP8_STATE_SERIALIZATION_INCLUDED
@@ -3,7 +3,6 @@
 #include <algorithm>
 #include <cassert>
 #include <iterator>
-#include <random>
 #include <ranges>
 #include <tuple>
 
@@ -51,10 +50,10 @@ namespace
 } // namespace
 
 vkchip8::chip8::chip8(size_t ram_size,
-    uint_fast32_t random_seed,
+    random_engine random,
     std::function<void(void)> beep_callback)
-    : memory_{ram_size, std::byte{}}
-    , random_engine_{random_seed}
+    : state_{.memory = std::vector<std::byte>(ram_size, std::byte{}),
+          .random = random}
     , beep_callback_{beep_callback}
 {
 }
@@ -63,61 +62,75 @@ void vkchip8::chip8::tick()
 {
     uint16_t const operation{fetch()};
     execute(operation);
+    ++state_.cycle;
 }
 
 void vkchip8::chip8::tick_timers()
 {
-    if (delay_timer_ > 0)
+    if (state_.delay_timer > 0)
     {
-        --delay_timer_;
+        --state_.delay_timer;
     }
 
-    if (sound_timer_ > 0)
+    if (state_.sound_timer > 0)
     {
-        if (sound_timer_ == 1)
+        if (state_.sound_timer == 1)
         {
             beep_callback_();
         }
-        --sound_timer_;
+        --state_.sound_timer;
     }
+
+    ++state_.frame;
 }
 
 void vkchip8::chip8::key_event(key_event_type type, key_code code)
 {
-    keys_.set(static_cast<size_t>(code), static_cast<bool>(type));
+    state_.keys.set(static_cast<size_t>(code), static_cast<bool>(type));
+}
+
+void vkchip8::chip8::restore_state(state const& saved)
+{
+    state_ = saved;
 }
 
 void vkchip8::chip8::load(std::span<std::byte const> program, uint16_t address)
 {
     reset();
-    std::ranges::copy(program, std::next(std::begin(memory_), start_address));
-    program_counter_ = address;
+    std::ranges::copy(program,
+        std::next(std::begin(state_.memory), start_address));
+    state_.program_counter = address;
 }
 
 void vkchip8::chip8::reset()
 {
-    std::ranges::copy(fontset, memory_.begin());
-    std::ranges::fill(memory_ | std::views::drop(fontset.size()), std::byte{});
+    std::ranges::copy(fontset, state_.memory.begin());
+    std::ranges::fill(state_.memory | std::views::drop(fontset.size()),
+        std::byte{});
 
-    program_counter_ = start_address;
-    std::ranges::fill(data_registers_, uint8_t{});
-    i_register_ = 0;
-    sound_timer_ = 0;
-    delay_timer_ = 0;
-    std::ranges::fill(screen_, std::bitset<screen_width>{});
-    std::ranges::fill(stack_, uint16_t{});
-    stack_pointer_ = 0;
-    keys_ = {};
+    state_.program_counter = start_address;
+    std::ranges::fill(state_.data_registers, uint8_t{});
+    state_.i_register = 0;
+    state_.sound_timer = 0;
+    state_.delay_timer = 0;
+    std::ranges::fill(state_.screen, std::bitset<screen_width>{});
+    std::ranges::fill(state_.stack, uint16_t{});
+    state_.stack_pointer = 0;
+    state_.keys = {};
+    state_.cycle = 0;
+    state_.frame = 0;
 }
 
 uint16_t vkchip8::chip8::fetch()
 {
-    assert(static_cast<uint16_t>(program_counter_ + 1) < memory_.size());
+    assert(static_cast<uint16_t>(state_.program_counter + 1) <
+        state_.memory.size());
 
-    auto const rv{static_cast<uint16_t>(memory_[program_counter_]) << 8 |
-        (static_cast<uint16_t>(memory_[program_counter_ + 1]))};
+    auto const rv{
+        static_cast<uint16_t>(state_.memory[state_.program_counter]) << 8 |
+        (static_cast<uint16_t>(state_.memory[state_.program_counter + 1]))};
 
-    program_counter_ += 2;
+    state_.program_counter += 2;
 
     return static_cast<uint16_t>(rv);
 }
@@ -133,163 +146,167 @@ void vkchip8::chip8::execute(uint16_t operation)
     else if (operation == 0x00'EE)
     {
         // Return from a subroutine
-        program_counter_ = pop_stack();
+        state_.program_counter = pop_stack();
     }
     else if (operation == 0x00'E0)
     {
         // Clear the screen
-        std::ranges::fill(screen_, 0);
+        std::ranges::fill(state_.screen, 0);
     }
     else if (digit1 == 0x1)
     {
         // Jump to address NNN
-        program_counter_ = from_hex_digits(0, digit2, digit3, digit4);
+        state_.program_counter = from_hex_digits(0, digit2, digit3, digit4);
     }
     else if (digit1 == 0x2)
     {
         // Execute subroutine at address NNN
-        push_stack(program_counter_);
-        program_counter_ = from_hex_digits(0, digit2, digit3, digit4);
+        push_stack(state_.program_counter);
+        state_.program_counter = from_hex_digits(0, digit2, digit3, digit4);
     }
     else if (digit1 == 0x3)
     {
         // Skip the following instruction if the value of register VX equals NN
-        if (data_registers_[digit2] == from_hex_digits(0, 0, digit3, digit4))
+        if (state_.data_registers[digit2] ==
+            from_hex_digits(0, 0, digit3, digit4))
         {
-            program_counter_ += 2;
+            state_.program_counter += 2;
         }
     }
     else if (digit1 == 0x4)
     {
         // Skip the following instruction if the value of register VX is not
         // equal to NN
-        if (data_registers_[digit2] != from_hex_digits(0, 0, digit3, digit4))
+        if (state_.data_registers[digit2] !=
+            from_hex_digits(0, 0, digit3, digit4))
         {
-            program_counter_ += 2;
+            state_.program_counter += 2;
         }
     }
     else if (digit1 == 0x5 && digit4 == 0x0)
     {
         // Skip the following instruction if the value of register VX is equal
         // to the value of register VY
-        if (data_registers_[digit2] == data_registers_[digit3])
+        if (state_.data_registers[digit2] == state_.data_registers[digit3])
         {
-            program_counter_ += 2;
+            state_.program_counter += 2;
         }
     }
     else if (digit1 == 0x6)
     {
         // Store number NN in register VX
-        data_registers_[digit2] = static_cast<uint8_t>(digit3 << 4 | digit4);
+        state_.data_registers[digit2] =
+            static_cast<uint8_t>(digit3 << 4 | digit4);
     }
     else if (digit1 == 0x7)
     {
         // Add the value NN to register VX
-        data_registers_[digit2] += static_cast<uint8_t>(digit3 << 4 | digit4);
+        state_.data_registers[digit2] +=
+            static_cast<uint8_t>(digit3 << 4 | digit4);
     }
     else if (digit1 == 0x8 && digit4 == 0x0)
     {
         // Store the value of register vy in register vx
-        data_registers_[digit2] = data_registers_[digit3];
+        state_.data_registers[digit2] = state_.data_registers[digit3];
     }
     else if (digit1 == 0x8 && digit4 == 0x1)
     {
         // Set VX to VX OR VY
-        data_registers_[digit2] |= data_registers_[digit3];
-        data_registers_[0xF] = {};
+        state_.data_registers[digit2] |= state_.data_registers[digit3];
+        state_.data_registers[0xF] = {};
     }
     else if (digit1 == 0x8 && digit4 == 0x2)
     {
         // Set VX to VX AND VY
-        data_registers_[digit2] &= data_registers_[digit3];
-        data_registers_[0xF] = {};
+        state_.data_registers[digit2] &= state_.data_registers[digit3];
+        state_.data_registers[0xF] = {};
     }
     else if (digit1 == 0x8 && digit4 == 0x3)
     {
         // Set VX to VX XOR VY
-        data_registers_[digit2] ^= data_registers_[digit3];
-        data_registers_[0xF] = {};
+        state_.data_registers[digit2] ^= state_.data_registers[digit3];
+        state_.data_registers[0xF] = {};
     }
     else if (digit1 == 0x8 && digit4 == 0x4)
     {
         // Add VY to VX with carry to VF
-        auto const vx{data_registers_[digit2]};
-        auto const vy{data_registers_[digit3]};
+        auto const vx{state_.data_registers[digit2]};
+        auto const vy{state_.data_registers[digit3]};
         auto const res{static_cast<uint8_t>(vx + vy)};
-        data_registers_[digit2] = res;
-        data_registers_[0xF] = res < vy;
+        state_.data_registers[digit2] = res;
+        state_.data_registers[0xF] = res < vy;
     }
     else if (digit1 == 0x8 && digit4 == 0x5)
     {
         // Subtract VY from VX to VX with borrow to VF
-        auto const vx{data_registers_[digit2]};
-        auto const vy{data_registers_[digit3]};
+        auto const vx{state_.data_registers[digit2]};
+        auto const vy{state_.data_registers[digit3]};
         auto const res{vx - vy};
-        data_registers_[digit2] = static_cast<uint8_t>(res);
-        data_registers_[0xF] = vx >= vy;
+        state_.data_registers[digit2] = static_cast<uint8_t>(res);
+        state_.data_registers[0xF] = vx >= vy;
     }
     else if (digit1 == 0x8 && digit4 == 0x6)
     {
         // Right shift VY by 1 to VX with carry to VF
-        auto const vy{data_registers_[digit3]};
-        data_registers_[digit2] = vy >> 1;
-        data_registers_[0xF] = vy & 0x1;
+        auto const vy{state_.data_registers[digit3]};
+        state_.data_registers[digit2] = vy >> 1;
+        state_.data_registers[0xF] = vy & 0x1;
     }
     else if (digit1 == 0x8 && digit4 == 0x7)
     {
         // Subtract VX from VY to VX with borrow to VF
-        auto const vx{data_registers_[digit2]};
-        auto const vy{data_registers_[digit3]};
+        auto const vx{state_.data_registers[digit2]};
+        auto const vy{state_.data_registers[digit3]};
         auto const res{vy - vx};
-        data_registers_[digit2] = static_cast<uint8_t>(res);
-        data_registers_[0xF] = vy >= vx;
+        state_.data_registers[digit2] = static_cast<uint8_t>(res);
+        state_.data_registers[0xF] = vy >= vx;
     }
     else if (digit1 == 0x8 && digit4 == 0xE)
     {
         // Left shift VY by 1 to VX with carry to VF
-        auto const vy{data_registers_[digit3]};
-        data_registers_[digit2] = vy << 1;
-        data_registers_[0xF] = (vy & 0x80) != 0;
+        auto const vy{state_.data_registers[digit3]};
+        state_.data_registers[digit2] = vy << 1;
+        state_.data_registers[0xF] = (vy & 0x80) != 0;
     }
     else if (digit1 == 0x9 && digit4 == 0x0)
     {
         // Skip the following instruction if VX != VY
-        if (data_registers_[digit2] != data_registers_[digit3])
+        if (state_.data_registers[digit2] != state_.data_registers[digit3])
         {
-            program_counter_ += 2;
+            state_.program_counter += 2;
         }
     }
     else if (digit1 == 0xA)
     {
         // Store memory address NNN in register I
-        i_register_ = from_hex_digits(0, digit2, digit3, digit4);
+        state_.i_register = from_hex_digits(0, digit2, digit3, digit4);
     }
     else if (digit1 == 0xB)
     {
         // Jump to address NNN + V0
-        program_counter_ =
-            from_hex_digits(0, digit2, digit3, digit4) + data_registers_[0];
+        state_.program_counter = from_hex_digits(0, digit2, digit3, digit4) +
+            state_.data_registers[0];
     }
     else if (digit1 == 0xC)
     {
         // Set VX to a random number with a mask of NN
-        data_registers_[digit2] =
-            static_cast<uint8_t>(std::uniform_int_distribution{0x00, 0xFF}(
-                random_engine_) &from_hex_digits(0, 0, digit3, digit4));
+        state_.data_registers[digit2] =
+            static_cast<uint8_t>(state_.random.next_byte() &
+                from_hex_digits(0, 0, digit3, digit4));
     }
     else if (digit1 == 0xD)
     {
         // Draw a sprite at position VX, VY with N bytes of sprite data stored
         // at I Set VF to 1 if any pixels are changed to unset
-        auto const x_coord{data_registers_[digit2]};
-        auto const y_coord{data_registers_[digit3]};
+        auto const x_coord{state_.data_registers[digit2]};
+        auto const y_coord{state_.data_registers[digit3]};
         size_t const rows{digit4};
 
         bool flipped{false};
         for (size_t sprite_row{}; sprite_row != rows; ++sprite_row)
         {
-            auto const address{i_register_ + sprite_row};
-            auto const& row_pixels{memory_[address]};
+            auto const address{state_.i_register + sprite_row};
+            auto const& row_pixels{state_.memory[address]};
             for (size_t sprite_column{}; sprite_column != 8; ++sprite_column)
             {
                 auto const sprite_bit{0x80 >> sprite_column};
@@ -298,42 +315,42 @@ void vkchip8::chip8::execute(uint16_t operation)
                     auto const screen_x{
                         (x_coord + sprite_column) % screen_width};
                     auto const screen_y{(y_coord + sprite_row) % screen_height};
-                    flipped |= screen_[screen_y].test(screen_x);
-                    screen_[screen_y].flip(screen_x);
+                    flipped |= state_.screen[screen_y].test(screen_x);
+                    state_.screen[screen_y].flip(screen_x);
                 }
             }
         }
 
-        data_registers_[0xF] = flipped;
+        state_.data_registers[0xF] = flipped;
     }
     else if (digit1 == 0xE && digit3 == 0x9 && digit4 == 0xE)
     {
-        auto const vx{data_registers_[digit2]};
-        if (vx < keys_.size() && keys_.test(vx))
+        auto const vx{state_.data_registers[digit2]};
+        if (vx < state_.keys.size() && state_.keys.test(vx))
         {
-            program_counter_ += 2;
+            state_.program_counter += 2;
         }
     }
     else if (digit1 == 0xE && digit3 == 0xA && digit4 == 0x1)
     {
-        auto const vx{data_registers_[digit2]};
-        if (vx < keys_.size() && !keys_.test(vx))
+        auto const vx{state_.data_registers[digit2]};
+        if (vx < state_.keys.size() && !state_.keys.test(vx))
         {
-            program_counter_ += 2;
+            state_.program_counter += 2;
         }
     }
     else if (digit1 == 0xF && digit3 == 0x0 && digit4 == 0x7)
     {
-        data_registers_[digit2] = delay_timer_;
+        state_.data_registers[digit2] = state_.delay_timer;
     }
     else if (digit1 == 0xF && digit3 == 0x0 && digit4 == 0xA)
     {
         bool pressed{false};
-        for (uint8_t i{}; i != keys_.size(); ++i)
+        for (uint8_t i{}; i != state_.keys.size(); ++i)
         {
-            if (keys_.test(i))
+            if (state_.keys.test(i))
             {
-                data_registers_[digit2] = i;
+                state_.data_registers[digit2] = i;
                 pressed = true;
                 break;
             }
@@ -341,38 +358,39 @@ void vkchip8::chip8::execute(uint16_t operation)
 
         if (!pressed)
         {
-            program_counter_ -= 2;
+            state_.program_counter -= 2;
         }
     }
     else if (digit1 == 0xF && digit3 == 0x1 && digit4 == 0x5)
     {
-        delay_timer_ = data_registers_[digit2];
+        state_.delay_timer = state_.data_registers[digit2];
     }
     else if (digit1 == 0xF && digit3 == 0x1 && digit4 == 0x8)
     {
-        sound_timer_ = data_registers_[digit2];
+        state_.sound_timer = state_.data_registers[digit2];
     }
     else if (digit1 == 0xF && digit3 == 0x1 && digit4 == 0xE)
     {
-        i_register_ += data_registers_[digit2];
+        state_.i_register += state_.data_registers[digit2];
     }
     else if (digit1 == 0xF && digit3 == 0x2 && digit4 == 0x9)
     {
-        i_register_ = data_registers_[digit2] * 5;
+        state_.i_register = state_.data_registers[digit2] * 5;
     }
     else if (digit1 == 0xF && digit3 == 0x3 && digit4 == 0x3)
     {
-        auto const vx{data_registers_[digit2]};
-        memory_[i_register_] = std::byte(vx / 100);
-        memory_[i_register_ + 1] = std::byte((vx / 10) % 10);
-        memory_[i_register_ + 2] = std::byte(vx % 10);
+        auto const vx{state_.data_registers[digit2]};
+        state_.memory[state_.i_register] = std::byte(vx / 100);
+        state_.memory[state_.i_register + 1] = std::byte((vx / 10) % 10);
+        state_.memory[state_.i_register + 2] = std::byte(vx % 10);
     }
     else if (digit1 == 0xF && digit3 == 0x5 && digit4 == 0x5)
     {
         auto x{digit2};
         for (uint8_t i{}; i != x + 1; ++i)
         {
-            memory_[i_register_++] = std::byte{data_registers_[i]};
+            state_.memory[state_.i_register++] =
+                std::byte{state_.data_registers[i]};
         }
     }
     else if (digit1 == 0xF && digit3 == 0x6 && digit4 == 0x5)
@@ -380,7 +398,8 @@ void vkchip8::chip8::execute(uint16_t operation)
         auto x{digit2};
         for (uint8_t i{}; i != x + 1; ++i)
         {
-            data_registers_[i] = static_cast<uint8_t>(memory_[i_register_++]);
+            state_.data_registers[i] =
+                static_cast<uint8_t>(state_.memory[state_.i_register++]);
         }
     }
     else
@@ -391,12 +410,12 @@ void vkchip8::chip8::execute(uint16_t operation)
 
 void vkchip8::chip8::push_stack(uint16_t const value)
 {
-    assert(stack_pointer_ + 1 < stack_.size());
-    stack_[stack_pointer_++] = value;
+    assert(state_.stack_pointer + 1 < state_.stack.size());
+    state_.stack[state_.stack_pointer++] = value;
 }
 
 uint16_t vkchip8::chip8::pop_stack()
 {
-    assert(stack_pointer_ >= 1);
-    return stack_[--stack_pointer_];
+    assert(state_.stack_pointer >= 1);
+    return state_.stack[--state_.stack_pointer];
 }
@@ -0,0 +1,273 @@
+#include <input_movie.hpp>
+
+#include <little_endian.hpp>
+#include <state_serialization.hpp>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+namespace
+{
+    constexpr std::array<char, 8> magic{'V', 'K', 'C', '8', 'M', 'O', 'V', 'I'};
+    constexpr uint32_t format_version{1};
+
+    template<std::unsigned_integral T>
+    void write(std::ostream& stream, T const value)
+    {
+        std::array<std::byte, sizeof(T)> buffer{};
+        vkchip8::store_le(buffer.data(), value);
+        // NOLINTNEXTLINE
+        stream.write(reinterpret_cast<char const*>(buffer.data()),
+            static_cast<std::streamsize>(buffer.size()));
+    }
+
+    template<std::unsigned_integral T>
+    [[nodiscard]] T read(std::istream& stream)
+    {
+        std::array<std::byte, sizeof(T)> buffer{};
+        // NOLINTNEXTLINE
+        if (!stream.read(reinterpret_cast<char*>(buffer.data()),
+                static_cast<std::streamsize>(buffer.size())))
+        {
+            throw std::runtime_error{"input movie is truncated"};
+        }
+
+        std::byte const* in{buffer.data()};
+        return vkchip8::load_le<T>(in);
+    }
+
+    // Addresses are 16 bit, a program can't use more memory than this
+    [[nodiscard]] size_t max_keyframe_size()
+    {
+        vkchip8::chip8::state state;
+        state.memory.resize(size_t{1} << 16);
+        return vkchip8::packed_size(state);
+    }
+} // namespace
+
+vkchip8::input_movie::input_movie(chip8 const& emulator,
+    uint64_t const seed,
+    uint32_t const cycles_per_frame,
+    uint32_t const keyframe_interval)
+    : seed_{seed}
+    , cycles_per_frame_{cycles_per_frame}
+    , keyframe_interval_{std::max(keyframe_interval, uint32_t{1})}
+    , last_frame_{emulator.current_state().frame}
+    , keyframes_{emulator.current_state()}
+{
+}
+
+void vkchip8::input_movie::record_event(chip8 const& emulator,
+    key_event_type const type,
+    key_code const code)
+{
+    auto const& state{emulator.current_state()};
+    events_.push_back({.frame = state.frame,
+        .cycle = state.cycle,
+        .type = type,
+        .code = code});
+}
+
+void vkchip8::input_movie::record_frame(chip8 const& emulator)
+{
+    auto const& state{emulator.current_state()};
+    last_frame_ = state.frame;
+    if ((last_frame_ - first_frame()) % keyframe_interval_ == 0)
+    {
+        keyframes_.push_back(state);
+    }
+}
+
+uint64_t vkchip8::input_movie::first_frame() const
+{
+    return keyframes_.front().frame;
+}
+
+uint64_t vkchip8::input_movie::last_frame() const { return last_frame_; }
+
+std::span<vkchip8::movie_event const> vkchip8::input_movie::events() const
+{
+    return events_;
+}
+
+vkchip8::chip8::state const& vkchip8::input_movie::keyframe_for(
+    uint64_t const frame) const
+{
+    auto const first{first_frame()};
+    uint64_t const index{
+        frame <= first ? 0 : (frame - first) / keyframe_interval_};
+    return keyframes_[std::min<uint64_t>(index, keyframes_.size() - 1)];
+}
+
+void vkchip8::input_movie::save(std::ostream& stream) const
+{
+    stream.write(magic.data(), static_cast<std::streamsize>(magic.size()));
+    write(stream, format_version);
+    write(stream, seed_);
+    write(stream, cycles_per_frame_);
+    write(stream, keyframe_interval_);
+    write(stream, last_frame_);
+
+    write<uint64_t>(stream, events_.size());
+    for (movie_event const& event : events_)
+    {
+        write(stream, event.frame);
+        write(stream, event.cycle);
+        write(stream, static_cast<uint8_t>(event.type));
+        write(stream, static_cast<uint8_t>(event.code));
+    }
+
+    std::vector<std::byte> packed;
+    write<uint64_t>(stream, keyframes_.size());
+    for (chip8::state const& keyframe : keyframes_)
+    {
+        packed.resize(packed_size(keyframe));
+        pack(keyframe, packed);
+
+        write(stream, static_cast<uint32_t>(packed.size()));
+        // NOLINTNEXTLINE
+        stream.write(reinterpret_cast<char const*>(packed.data()),
+            static_cast<std::streamsize>(packed.size()));
+    }
+
+    if (!stream)
+    {
+        throw std::runtime_error{"failed to write input movie"};
+    }
+}
+
+vkchip8::input_movie vkchip8::input_movie::load(std::istream& stream)
+{
+    std::array<char, magic.size()> file_magic{};
+    if (!stream.read(file_magic.data(),
+            static_cast<std::streamsize>(file_magic.size())) ||
+        file_magic != magic)
+    {
+        throw std::runtime_error{"not an input movie"};
+    }
+
+    if (read<uint32_t>(stream) != format_version)
+    {
+        throw std::runtime_error{"unsupported input movie version"};
+    }
+
+    input_movie rv;
+    rv.seed_ = read<uint64_t>(stream);
+    rv.cycles_per_frame_ = read<uint32_t>(stream);
+    rv.keyframe_interval_ = read<uint32_t>(stream);
+    rv.last_frame_ = read<uint64_t>(stream);
+    if (rv.cycles_per_frame_ == 0 || rv.keyframe_interval_ == 0)
+    {
+        throw std::runtime_error{"invalid input movie timing"};
+    }
+
+    auto const event_count{read<uint64_t>(stream)};
+    for (uint64_t i{}; i != event_count; ++i)
+    {
+        movie_event event;
+        event.frame = read<uint64_t>(stream);
+        event.cycle = read<uint64_t>(stream);
+        auto const type{read<uint8_t>(stream)};
+        auto const code{read<uint8_t>(stream)};
+        if (type > static_cast<uint8_t>(key_event_type::pressed) ||
+            code > static_cast<uint8_t>(key_code::kF))
+        {
+            throw std::runtime_error{"invalid input movie event"};
+        }
+        event.type = static_cast<key_event_type>(type);
+        event.code = static_cast<key_code>(code);
+        rv.events_.push_back(event);
+    }
+
+    std::vector<std::byte> packed;
+    auto const keyframe_count{read<uint64_t>(stream)};
+    for (uint64_t i{}; i != keyframe_count; ++i)
+    {
+        // Keyframes of one movie share the memory size of the first
+        auto const size{read<uint32_t>(stream)};
+        if (rv.keyframes_.empty() ? size > max_keyframe_size()
+                                  : size != packed_size(rv.keyframes_.front()))
+        {
+            throw std::runtime_error{"invalid input movie keyframe size"};
+        }
+
+        packed.resize(size);
+        // NOLINTNEXTLINE
+        if (!stream.read(reinterpret_cast<char*>(packed.data()),
+                static_cast<std::streamsize>(packed.size())))
+        {
+            throw std::runtime_error{"input movie is truncated"};
+        }
+
+        unpack(packed, rv.keyframes_.emplace_back());
+    }
+
+    if (rv.keyframes_.empty())
+    {
+        throw std::runtime_error{"input movie has no keyframes"};
+    }
+
+    return rv;
+}
+
+vkchip8::movie_player::movie_player(input_movie const* const movie,
+    chip8* const emulator)
+    : movie_{movie}
+    , emulator_{emulator}
+{
+    seek(movie_->first_frame());
+}
+
+void vkchip8::movie_player::run_frame()
+{
+    for (uint32_t i{}; i != movie_->cycles_per_frame(); ++i)
+    {
+        apply_pending_events();
+        emulator_->tick();
+    }
+
+    emulator_->tick_timers();
+}
+
+void vkchip8::movie_player::seek(uint64_t const frame)
+{
+    auto const target{
+        std::clamp(frame, movie_->first_frame(), movie_->last_frame())};
+
+    auto const& keyframe{movie_->keyframe_for(target)};
+    emulator_->restore_state(keyframe);
+
+    // Events stamped with the keyframe cycle were applied after it was taken
+    auto const events{movie_->events()};
+    next_event_ = static_cast<size_t>(std::distance(events.begin(),
+        std::ranges::lower_bound(events,
+            keyframe.cycle,
+            {},
+            &movie_event::cycle)));
+
+    while (emulator_->current_state().frame < target)
+    {
+        run_frame();
+    }
+}
+
+bool vkchip8::movie_player::finished() const
+{
+    return emulator_->current_state().frame >= movie_->last_frame();
+}
+
+void vkchip8::movie_player::apply_pending_events()
+{
+    auto const events{movie_->events()};
+    auto const cycle{emulator_->current_state().cycle};
+    while (next_event_ != events.size() && events[next_event_].cycle <= cycle)
+    {
+        emulator_->key_event(events[next_event_].type,
+            events[next_event_].code);
+        ++next_event_;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef VKCHIP8_LITTLE_ENDIAN_INCLUDED
+#define VKCHIP8_LITTLE_ENDIAN_INCLUDED
+
+#include <concepts>
+#include <cstddef>
+
+namespace vkchip8
+{
+    template<std::unsigned_integral T>
+    std::byte* store_le(std::byte* out, T const value)
+    {
+        for (size_t i{}; i != sizeof(T); ++i)
+        {
+            *out++ = static_cast<std::byte>(value >> (8 * i));
+        }
+        return out;
+    }
+
+    template<std::unsigned_integral T>
+    [[nodiscard]] T load_le(std::byte const*& in)
+    {
+        T rv{};
+        for (size_t i{}; i != sizeof(T); ++i)
+        {
+            rv |= static_cast<T>(static_cast<T>(*in++) << (8 * i));
+        }
+        return rv;
+    }
+} // namespace vkchip8
+
+#endif // !VKCHIP8_LITTLE_ENDIAN_INCLUDED
@@ -0,0 +1,284 @@
+#include <rewind_buffer.hpp>
+
+#include <state_serialization.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    [[nodiscard]] std::byte* write_varint(std::byte* out, size_t value)
+    {
+        while (value >= 0x80)
+        {
+            *out++ = static_cast<std::byte>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        *out++ = static_cast<std::byte>(value);
+        return out;
+    }
+
+    [[nodiscard]] size_t read_varint(std::byte const*& in)
+    {
+        size_t rv{};
+        for (unsigned shift{};; shift += 7)
+        {
+            auto const byte{std::to_integer<size_t>(*in++)};
+            rv |= (byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return rv;
+            }
+        }
+    }
+
+    // Encodes image XOR keyframe as a sequence of (skip, length, bytes)
+    // tokens, where skip is the number of unchanged bytes. Returns the encoded
+    // size or zero if it wouldn't be smaller than the image itself.
+    [[nodiscard]] size_t encode_delta(std::span<std::byte const> const image,
+        std::span<std::byte const> const keyframe,
+        std::span<std::byte> const out)
+    {
+        assert(image.size() == keyframe.size());
+
+        auto const size{image.size()};
+        std::byte* cursor{out.data()};
+        std::byte* const limit{out.data() + size};
+
+        size_t i{};
+        while (i != size)
+        {
+            size_t const skip_start{i};
+            while (i != size && image[i] == keyframe[i])
+            {
+                ++i;
+            }
+            if (i == size)
+            {
+                break;
+            }
+
+            size_t const literal_start{i};
+            while (i != size && image[i] != keyframe[i])
+            {
+                ++i;
+            }
+
+            size_t const length{i - literal_start};
+            // Two varints of at most 10 bytes each
+            if (static_cast<size_t>(limit - cursor) < length + 20)
+            {
+                return 0;
+            }
+
+            cursor = write_varint(cursor, literal_start - skip_start);
+            cursor = write_varint(cursor, length);
+            for (size_t j{literal_start}; j != i; ++j)
+            {
+                *cursor++ = image[j] ^ keyframe[j];
+            }
+        }
+
+        return static_cast<size_t>(cursor - out.data());
+    }
+
+    void apply_delta(std::span<std::byte const> const delta,
+        std::span<std::byte> const image)
+    {
+        std::byte const* in{delta.data()};
+        std::byte const* const end{delta.data() + delta.size()};
+
+        size_t position{};
+        while (in != end)
+        {
+            position += read_varint(in);
+            auto const length{read_varint(in)};
+            for (size_t j{}; j != length; ++j)
+            {
+                image[position++] ^= *in++;
+            }
+        }
+    }
+} // namespace
+
+vkchip8::rewind_buffer::rewind_buffer(size_t const max_snapshots,
+    size_t const arena_size,
+    uint32_t const keyframe_interval)
+    : entries_(max_snapshots)
+    , arena_(arena_size)
+    , keyframe_interval_{std::max(keyframe_interval, uint32_t{1})}
+{
+    if (max_snapshots == 0)
+    {
+        throw std::runtime_error{"rewind buffer needs at least one snapshot"};
+    }
+}
+
+void vkchip8::rewind_buffer::push(chip8::state const& state)
+{
+    image_.resize(packed_size(state));
+    pack(state, image_);
+
+    if (image_.size() > arena_.size())
+    {
+        throw std::runtime_error{"rewind buffer arena is too small"};
+    }
+
+    bool is_keyframe{count_ == 0 || since_keyframe_ >= keyframe_interval_ ||
+        keyframe_sequence_ < first_sequence_ ||
+        image_.size() != keyframe_image_.size()};
+
+    size_t delta_size{};
+    if (!is_keyframe)
+    {
+        delta_.resize(image_.size());
+        delta_size = encode_delta(image_, keyframe_image_, delta_);
+        is_keyframe = delta_size == 0;
+    }
+
+    if (count_ == entries_.size())
+    {
+        evict_oldest();
+    }
+
+    size_t offset{allocate(is_keyframe ? image_.size() : delta_size)};
+    // Making room evicted the keyframe this delta is based on, and with it
+    // every other snapshot
+    if (!is_keyframe && count_ == 0)
+    {
+        is_keyframe = true;
+        offset = allocate(image_.size());
+    }
+
+    uint64_t const sequence{first_sequence_ + count_};
+    if (is_keyframe)
+    {
+        std::ranges::copy(image_,
+            arena_.begin() + static_cast<ptrdiff_t>(offset));
+        keyframe_image_ = image_;
+        keyframe_sequence_ = sequence;
+        since_keyframe_ = 0;
+    }
+    else
+    {
+        std::copy_n(delta_.cbegin(),
+            delta_size,
+            arena_.begin() + static_cast<ptrdiff_t>(offset));
+    }
+    ++since_keyframe_;
+
+    size_t const size{is_keyframe ? image_.size() : delta_size};
+    ++count_;
+    at(sequence) = {.offset = offset,
+        .size = size,
+        .keyframe = keyframe_sequence_,
+        .is_keyframe = is_keyframe};
+    used_bytes_ += size;
+}
+
+bool vkchip8::rewind_buffer::pop(chip8::state& state)
+{
+    if (count_ == 0)
+    {
+        return false;
+    }
+
+    uint64_t const sequence{first_sequence_ + count_ - 1};
+    entry const newest{at(sequence)};
+    std::span<std::byte const> const data{arena_.data() + newest.offset,
+        newest.size};
+
+    if (newest.is_keyframe)
+    {
+        unpack(data, state);
+    }
+    else
+    {
+        entry const& keyframe{at(newest.keyframe)};
+        image_.assign(arena_.cbegin() + static_cast<ptrdiff_t>(keyframe.offset),
+            arena_.cbegin() +
+                static_cast<ptrdiff_t>(keyframe.offset + keyframe.size));
+        apply_delta(data, image_);
+        unpack(image_, state);
+    }
+
+    --count_;
+    head_ = newest.offset;
+    used_bytes_ -= newest.size;
+    // The cached keyframe image may be newer than what is left in the buffer
+    since_keyframe_ = keyframe_interval_;
+
+    return true;
+}
+
+void vkchip8::rewind_buffer::clear()
+{
+    first_ = 0;
+    count_ = 0;
+    first_sequence_ = 0;
+    head_ = 0;
+    used_bytes_ = 0;
+    since_keyframe_ = 0;
+    keyframe_sequence_ = 0;
+}
+
+size_t vkchip8::rewind_buffer::size() const { return count_; }
+
+size_t vkchip8::rewind_buffer::used_bytes() const { return used_bytes_; }
+
+size_t vkchip8::rewind_buffer::arena_size() const { return arena_.size(); }
+
+vkchip8::rewind_buffer::entry& vkchip8::rewind_buffer::at(
+    uint64_t const sequence)
+{
+    assert(sequence >= first_sequence_ && sequence - first_sequence_ < count_);
+    return entries_[(first_ + (sequence - first_sequence_)) % entries_.size()];
+}
+
+size_t vkchip8::rewind_buffer::allocate(size_t const size)
+{
+    // Live snapshots occupy [tail, head) of the arena, possibly wrapping
+    // around its end
+    for (;;)
+    {
+        if (count_ == 0)
+        {
+            head_ = size;
+            return 0;
+        }
+
+        size_t const tail{entries_[first_].offset};
+        if (head_ > tail)
+        {
+            if (arena_.size() - head_ >= size)
+            {
+                return std::exchange(head_, head_ + size);
+            }
+
+            if (tail >= size)
+            {
+                head_ = size;
+                return 0;
+            }
+        }
+        else if (tail - head_ >= size)
+        {
+            return std::exchange(head_, head_ + size);
+        }
+
+        evict_oldest();
+    }
+}
+
+void vkchip8::rewind_buffer::evict_oldest()
+{
+    do
+    {
+        used_bytes_ -= entries_[first_].size;
+        first_ = (first_ + 1) % entries_.size();
+        ++first_sequence_;
+        --count_;
+    } while (count_ != 0 && !entries_[first_].is_keyframe);
+}
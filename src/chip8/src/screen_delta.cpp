@@ -0,0 +1,190 @@
+#include <screen_delta.hpp>
+
+#include <little_endian.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <bitset>
+#include <concepts>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+
+namespace
+{
+    constexpr std::array<char, 8> magic{'V', 'K', 'C', '8', 'S', 'C', 'R', 'N'};
+    constexpr uint32_t format_version{1};
+
+    constexpr size_t header_size{magic.size() + sizeof(uint32_t)};
+
+    constexpr size_t max_record_size{sizeof(uint32_t) +
+        vkchip8::chip8::screen_height * sizeof(uint64_t) + sizeof(uint64_t)};
+
+    static_assert(vkchip8::chip8::screen_width == 64 &&
+        vkchip8::chip8::screen_height <= 32);
+
+    [[nodiscard]] bool read_bytes(std::istream& stream,
+        std::span<std::byte> const buffer)
+    {
+        // NOLINTNEXTLINE
+        stream.read(reinterpret_cast<char*>(buffer.data()),
+            static_cast<std::streamsize>(buffer.size()));
+        return stream.gcount() == static_cast<std::streamsize>(buffer.size());
+    }
+
+    template<std::unsigned_integral T>
+    [[nodiscard]] T read(std::istream& stream)
+    {
+        std::array<std::byte, sizeof(T)> buffer{};
+        if (!read_bytes(stream, buffer))
+        {
+            throw std::runtime_error{"screen delta stream is truncated"};
+        }
+
+        std::byte const* in{buffer.data()};
+        return vkchip8::load_le<T>(in);
+    }
+} // namespace
+
+uint64_t vkchip8::screen_hash(chip8::screen_rows const& screen)
+{
+    uint64_t rv{0xCBF29CE484222325};
+    for (auto const& row : screen)
+    {
+        uint64_t const bits{row.to_ullong()};
+        for (size_t i{}; i != sizeof(bits); ++i)
+        {
+            rv ^= (bits >> (8 * i)) & 0xFF;
+            rv *= 0x100000001B3;
+        }
+    }
+    return rv;
+}
+
+vkchip8::screen_delta_writer::screen_delta_writer(std::ostream* const stream,
+    size_t const buffer_size)
+    : stream_{stream}
+    , buffer_(std::max(buffer_size, header_size + max_record_size))
+{
+    auto const magic_bytes{std::as_bytes(std::span{magic})};
+    std::byte* out{std::ranges::copy(magic_bytes, buffer_.data()).out};
+    out = store_le(out, format_version);
+    used_ = static_cast<size_t>(out - buffer_.data());
+}
+
+vkchip8::screen_delta_writer::~screen_delta_writer() { write_buffer(); }
+
+void vkchip8::screen_delta_writer::write(chip8::screen_rows const& screen)
+{
+    if (buffer_.size() - used_ < max_record_size)
+    {
+        write_buffer();
+    }
+
+    std::byte* const mask_out{buffer_.data() + used_};
+    std::byte* out{mask_out + sizeof(uint32_t)};
+
+    uint32_t mask{};
+    for (size_t y{}; y != screen.size(); ++y)
+    {
+        auto const delta{(screen[y] ^ previous_[y]).to_ullong()};
+        if (delta != 0)
+        {
+            mask |= uint32_t{1} << y;
+            out = store_le<uint64_t>(out, delta);
+        }
+    }
+    store_le(mask_out, mask);
+    out = store_le(out, screen_hash(screen));
+
+    used_ = static_cast<size_t>(out - buffer_.data());
+    previous_ = screen;
+    ++frames_;
+}
+
+void vkchip8::screen_delta_writer::flush()
+{
+    write_buffer();
+    if (!stream_->flush())
+    {
+        throw std::runtime_error{"failed to write screen delta stream"};
+    }
+}
+
+void vkchip8::screen_delta_writer::write_buffer()
+{
+    // NOLINTNEXTLINE
+    stream_->write(reinterpret_cast<char const*>(buffer_.data()),
+        static_cast<std::streamsize>(used_));
+    used_ = 0;
+}
+
+vkchip8::screen_delta_reader::screen_delta_reader(std::istream* const stream)
+    : stream_{stream}
+{
+    std::array<char, magic.size()> file_magic{};
+    if (!read_bytes(*stream_, std::as_writable_bytes(std::span{file_magic})) ||
+        file_magic != magic)
+    {
+        throw std::runtime_error{"not a screen delta stream"};
+    }
+
+    if (read<uint32_t>(*stream_) != format_version)
+    {
+        throw std::runtime_error{"unsupported screen delta stream version"};
+    }
+
+    hash_ = screen_hash(screen_);
+}
+
+bool vkchip8::screen_delta_reader::next()
+{
+    std::array<std::byte, sizeof(uint32_t)> mask_bytes{};
+    if (!read_bytes(*stream_, mask_bytes))
+    {
+        if (stream_->gcount() == 0)
+        {
+            return false;
+        }
+        throw std::runtime_error{"screen delta stream is truncated"};
+    }
+
+    std::byte const* in{mask_bytes.data()};
+    auto mask{load_le<uint32_t>(in)};
+    if (std::bit_width(mask) > screen_.size())
+    {
+        throw std::runtime_error{"invalid screen delta record"};
+    }
+
+    unchanged_ = mask == 0;
+    while (mask != 0)
+    {
+        auto const y{static_cast<size_t>(std::countr_zero(mask))};
+        auto const delta{read<uint64_t>(*stream_)};
+        screen_[y] ^= std::bitset<chip8::screen_width>{delta};
+        mask &= mask - 1;
+    }
+
+    hash_ = read<uint64_t>(*stream_);
+    if (hash_ != screen_hash(screen_))
+    {
+        throw std::runtime_error{"screen delta hash mismatch"};
+    }
+
+    ++frames_;
+    return true;
+}
+
+bool vkchip8::screen_delta_reader::seek(uint64_t const frame)
+{
+    while (frames_ <= frame)
+    {
+        if (!next())
+        {
+            return false;
+        }
+    }
+    return frames_ == frame + 1;
+}
@@ -0,0 +1,110 @@
+#include <state_serialization.hpp>
+
+#include <little_endian.hpp>
+#include <random_engine.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace
+{
+    // Everything except memory, see pack() for the layout
+    constexpr size_t fixed_size{sizeof(uint32_t) + sizeof(uint16_t) + 16 +
+        sizeof(uint16_t) + 2 * sizeof(uint8_t) +
+        vkchip8::chip8::screen_height * sizeof(uint64_t) +
+        vkchip8::chip8::stack_size * sizeof(uint16_t) + sizeof(uint8_t) +
+        sizeof(uint16_t) + 4 * sizeof(uint64_t)};
+} // namespace
+
+size_t vkchip8::packed_size(chip8::state const& state)
+{
+    return fixed_size + state.memory.size();
+}
+
+void vkchip8::pack(chip8::state const& state, std::span<std::byte> buffer)
+{
+    if (buffer.size() != packed_size(state))
+    {
+        throw std::runtime_error{"invalid packed state buffer size"};
+    }
+
+    std::byte* out{buffer.data()};
+    out = store_le(out, static_cast<uint32_t>(state.memory.size()));
+    out = std::ranges::copy(state.memory, out).out;
+    out = store_le(out, state.program_counter);
+    for (uint8_t const value : state.data_registers)
+    {
+        out = store_le(out, value);
+    }
+    out = store_le(out, state.i_register);
+    out = store_le(out, state.sound_timer);
+    out = store_le(out, state.delay_timer);
+    for (auto const& row : state.screen)
+    {
+        out = store_le(out, static_cast<uint64_t>(row.to_ullong()));
+    }
+    for (uint16_t const value : state.stack)
+    {
+        out = store_le(out, value);
+    }
+    out = store_le(out, static_cast<uint8_t>(state.stack_pointer));
+    out = store_le(out, static_cast<uint16_t>(state.keys.to_ulong()));
+    out = store_le(out, state.random.state());
+    out = store_le(out, state.random.increment());
+    out = store_le(out, state.cycle);
+    store_le(out, state.frame);
+}
+
+void vkchip8::unpack(std::span<std::byte const> buffer, chip8::state& state)
+{
+    if (buffer.size() < fixed_size)
+    {
+        throw std::runtime_error{"packed state is truncated"};
+    }
+
+    std::byte const* in{buffer.data()};
+    auto const memory_size{load_le<uint32_t>(in)};
+    if (buffer.size() != fixed_size + memory_size)
+    {
+        throw std::runtime_error{"packed state memory size mismatch"};
+    }
+
+    state.memory.assign(in, in + memory_size);
+    in += memory_size;
+    state.program_counter = load_le<uint16_t>(in);
+    for (uint8_t& value : state.data_registers)
+    {
+        value = load_le<uint8_t>(in);
+    }
+    state.i_register = load_le<uint16_t>(in);
+    state.sound_timer = load_le<uint8_t>(in);
+    state.delay_timer = load_le<uint8_t>(in);
+    for (auto& row : state.screen)
+    {
+        row = load_le<uint64_t>(in);
+    }
+    for (uint16_t& value : state.stack)
+    {
+        value = load_le<uint16_t>(in);
+    }
+    state.stack_pointer = load_le<uint8_t>(in);
+    state.keys = load_le<uint16_t>(in);
+    auto const random_state{load_le<uint64_t>(in)};
+    auto const random_increment{load_le<uint64_t>(in)};
+    state.random =
+        random_engine::from_state(random_state, random_increment);
+    state.cycle = load_le<uint64_t>(in);
+    state.frame = load_le<uint64_t>(in);
+
+    // Both bytes of the next instruction have to be in memory
+    if (size_t{state.program_counter} + 1 >= state.memory.size())
+    {
+        throw std::runtime_error{"packed state program counter out of range"};
+    }
+
+    if (state.stack_pointer > state.stack.size())
+    {
+        throw std::runtime_error{"packed state stack pointer out of range"};
+    }
+}
@@ -0,0 +1,333 @@
+#include <chip8.hpp>
+#include <input_movie.hpp>
+#include <random_engine.hpp>
+#include <rewind_buffer.hpp>
+#include <screen_delta.hpp>
+#include <state_serialization.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("random engine matches PCG32 reference output", "[random]")
+{
+    vkchip8::random_engine engine{42, 54};
+
+    CHECK(engine() == 0xa15c02b7);
+    CHECK(engine() == 0x7b47f409);
+    CHECK(engine() == 0xba1d3330);
+}
+
+TEST_CASE("random engine instances have independent streams", "[random]")
+{
+    auto first{vkchip8::random_engine::for_instance(1234, 0)};
+    auto second{vkchip8::random_engine::for_instance(1234, 1)};
+    auto first_again{vkchip8::random_engine::for_instance(1234, 0)};
+
+    CHECK(first != second);
+    CHECK(first == first_again);
+
+    auto const restored{vkchip8::random_engine::from_state(first.state(),
+        first.increment())};
+    CHECK(restored == first);
+}
+
+TEST_CASE("random numbers are part of the saved state", "[chip8][random]")
+{
+    // CXNN: V0 = random & 0xFF, then jump back to itself
+    constexpr std::array program{std::byte{0xC0},
+        std::byte{0xFF},
+        std::byte{0x12},
+        std::byte{0x00}};
+
+    vkchip8::chip8 emulator{vkchip8::chip8::memory_size,
+        vkchip8::random_engine{7}};
+    emulator.load(program);
+    emulator.tick();
+    emulator.tick();
+
+    auto const saved{emulator.current_state()};
+
+    std::array<uint8_t, 8> expected{};
+    for (auto& value : expected)
+    {
+        emulator.tick();
+        emulator.tick();
+        value = emulator.current_state().data_registers[0];
+    }
+
+    emulator.restore_state(saved);
+    REQUIRE(emulator.current_state() == saved);
+    for (auto const value : expected)
+    {
+        emulator.tick();
+        emulator.tick();
+        CHECK(emulator.current_state().data_registers[0] == value);
+    }
+}
+
+TEST_CASE("unpacking rejects out of range registers", "[serialization]")
+{
+    vkchip8::chip8 const emulator;
+    auto state{emulator.current_state()};
+    std::vector<std::byte> buffer(vkchip8::packed_size(state));
+    vkchip8::chip8::state unpacked;
+
+    state.stack_pointer = vkchip8::chip8::stack_size;
+    state.program_counter = vkchip8::chip8::memory_size - 2;
+    vkchip8::pack(state, buffer);
+    vkchip8::unpack(buffer, unpacked);
+    CHECK(unpacked == state);
+
+    SECTION("stack pointer past the end of the stack")
+    {
+        state.stack_pointer = vkchip8::chip8::stack_size + 1;
+        vkchip8::pack(state, buffer);
+        CHECK_THROWS_AS(vkchip8::unpack(buffer, unpacked), std::runtime_error);
+    }
+    SECTION("program counter at the last byte of memory")
+    {
+        state.program_counter = vkchip8::chip8::memory_size - 1;
+        vkchip8::pack(state, buffer);
+        CHECK_THROWS_AS(vkchip8::unpack(buffer, unpacked), std::runtime_error);
+    }
+}
+
+TEST_CASE("input movie replays and seeks recorded frames", "[input_movie]")
+{
+    // V1 = random, V2 += 1, V3 += 1 while key 0 is held, loop
+    constexpr std::array program{std::byte{0xC1},
+        std::byte{0xFF},
+        std::byte{0x72},
+        std::byte{0x01},
+        std::byte{0xE0},
+        std::byte{0x9E},
+        std::byte{0x12},
+        std::byte{0x00},
+        std::byte{0x73},
+        std::byte{0x01},
+        std::byte{0x12},
+        std::byte{0x00}};
+    constexpr uint32_t cycles_per_frame{16};
+
+    vkchip8::chip8 emulator{vkchip8::chip8::memory_size,
+        vkchip8::random_engine{99}};
+    emulator.load(program);
+
+    vkchip8::input_movie movie{emulator, 99, cycles_per_frame, 4};
+    std::vector<vkchip8::chip8::state> recorded{emulator.current_state()};
+    for (int frame{}; frame != 20; ++frame)
+    {
+        if (frame == 3 || frame == 9)
+        {
+            auto const type{frame == 3 ? vkchip8::key_event_type::pressed
+                                       : vkchip8::key_event_type::released};
+            emulator.key_event(type, vkchip8::key_code::k0);
+            movie.record_event(emulator, type, vkchip8::key_code::k0);
+        }
+
+        for (uint32_t i{}; i != cycles_per_frame; ++i)
+        {
+            emulator.tick();
+        }
+        emulator.tick_timers();
+
+        movie.record_frame(emulator);
+        recorded.push_back(emulator.current_state());
+    }
+    REQUIRE(emulator.current_state().data_registers[3] != 0);
+
+    std::stringstream stream;
+    movie.save(stream);
+    auto const loaded{vkchip8::input_movie::load(stream)};
+    CHECK(loaded.seed() == 99);
+    CHECK(std::ranges::equal(loaded.events(), movie.events()));
+
+    vkchip8::chip8 replay;
+    vkchip8::movie_player player{&loaded, &replay};
+    CHECK(replay.current_state() == recorded.front());
+    while (!player.finished())
+    {
+        player.run_frame();
+        auto const frame{replay.current_state().frame};
+        REQUIRE(replay.current_state() == recorded[frame]);
+    }
+
+    player.seek(13);
+    CHECK(replay.current_state() == recorded[13]);
+    player.seek(2);
+    CHECK(replay.current_state() == recorded[2]);
+}
+
+TEST_CASE("input movie rejects keyframes of the wrong size", "[input_movie]")
+{
+    vkchip8::chip8 emulator;
+    vkchip8::input_movie movie{emulator, 1, 16, 1};
+    emulator.tick_timers();
+    movie.record_frame(emulator);
+
+    std::stringstream saved;
+    movie.save(saved);
+    std::string const original{saved.str()};
+
+    // Header, empty event list and keyframe count come before the first
+    // keyframe size
+    constexpr size_t first_size_offset{52};
+    auto const load_with_size{[&original](size_t const offset,
+                                  uint32_t const size)
+        {
+            std::string modified{original};
+            for (size_t i{}; i != sizeof(size); ++i)
+            {
+                modified[offset + i] = static_cast<char>(size >> (8 * i));
+            }
+            std::istringstream stream{modified};
+            return vkchip8::input_movie::load(stream);
+        }};
+
+    size_t const size{vkchip8::packed_size(emulator.current_state())};
+    CHECK_NOTHROW(load_with_size(first_size_offset,
+        static_cast<uint32_t>(size)));
+    CHECK_THROWS_WITH(load_with_size(first_size_offset, 0xFFFF'FFFF),
+        "invalid input movie keyframe size");
+    CHECK_THROWS_WITH(load_with_size(first_size_offset + 4 + size,
+                          static_cast<uint32_t>(size + 1)),
+        "invalid input movie keyframe size");
+}
+
+TEST_CASE("rewind buffer restores snapshots newest first", "[rewind]")
+{
+    vkchip8::chip8 emulator;
+    std::array const program{std::byte{0x60},
+        std::byte{0x00},
+        std::byte{0xA3},
+        std::byte{0x00},
+        std::byte{0x70},
+        std::byte{0x01},
+        std::byte{0xF0},
+        std::byte{0x55},
+        std::byte{0x12},
+        std::byte{0x04}};
+    emulator.load(program);
+
+    vkchip8::rewind_buffer rewind{32, 64 * 1024, 4};
+
+    std::vector<vkchip8::chip8::state> captured;
+    for (int frame{}; frame != 20; ++frame)
+    {
+        for (int i{}; i != 16; ++i)
+        {
+            emulator.tick();
+        }
+        emulator.tick_timers();
+
+        rewind.push(emulator.current_state());
+        captured.push_back(emulator.current_state());
+    }
+    REQUIRE(rewind.size() == captured.size());
+    // Deltas against the keyframe touch only a few bytes
+    CHECK(rewind.used_bytes() <
+        5 * vkchip8::packed_size(captured.front()) + 15 * 64);
+
+    vkchip8::chip8::state restored;
+    for (size_t i{captured.size()}; i != 10; --i)
+    {
+        REQUIRE(rewind.pop(restored));
+        REQUIRE(restored == captured[i - 1]);
+    }
+
+    // Continue from a rewound state
+    emulator.restore_state(restored);
+    rewind.push(emulator.current_state());
+    REQUIRE(rewind.pop(restored));
+    CHECK(restored == captured[10]);
+    REQUIRE(rewind.pop(restored));
+    CHECK(restored == captured[9]);
+}
+
+TEST_CASE("rewind buffer drops oldest snapshots when full", "[rewind]")
+{
+    vkchip8::chip8 emulator;
+    auto const image_size{vkchip8::packed_size(emulator.current_state())};
+
+    vkchip8::rewind_buffer rewind{1000, 3 * image_size, 2};
+    std::vector<vkchip8::chip8::state> captured;
+    for (int frame{}; frame != 50; ++frame)
+    {
+        emulator.tick_timers();
+        rewind.push(emulator.current_state());
+        captured.push_back(emulator.current_state());
+        REQUIRE(rewind.used_bytes() <= rewind.arena_size());
+    }
+    REQUIRE(rewind.size() > 2);
+    REQUIRE(rewind.size() < captured.size());
+
+    vkchip8::chip8::state restored;
+    size_t popped{};
+    while (rewind.pop(restored))
+    {
+        ++popped;
+        REQUIRE(restored == captured[captured.size() - popped]);
+    }
+}
+
+TEST_CASE("screen delta stream reconstructs every frame", "[screen_delta]")
+{
+    std::vector<vkchip8::chip8::screen_rows> screens(1);
+    for (size_t frame{1}; frame != 40; ++frame)
+    {
+        auto& screen{screens.emplace_back(screens.back())};
+        if (frame % 4 != 0)
+        {
+            screen[frame % screen.size()].flip(frame);
+            screen[(frame * 7) % screen.size()].flip(63 - frame);
+        }
+    }
+
+    std::stringstream stream;
+    {
+        vkchip8::screen_delta_writer writer{&stream, 0};
+        for (auto const& screen : screens)
+        {
+            writer.write(screen);
+        }
+        writer.flush();
+        CHECK(writer.frames() == screens.size());
+    }
+
+    std::string const encoded{stream.str()};
+    size_t const header_size{12};
+    size_t const unchanged_size{12};
+    CHECK(encoded.size() < header_size + screens.size() * 3 * unchanged_size);
+
+    vkchip8::screen_delta_reader reader{&stream};
+    while (reader.next())
+    {
+        auto const frame{reader.frames() - 1};
+        REQUIRE(reader.screen() == screens[frame]);
+        CHECK(reader.hash() == vkchip8::screen_hash(screens[frame]));
+        CHECK(reader.unchanged() == (frame % 4 == 0));
+    }
+    CHECK(reader.frames() == screens.size());
+
+    std::stringstream seek_stream{encoded};
+    vkchip8::screen_delta_reader seeker{&seek_stream};
+    REQUIRE(seeker.seek(25));
+    CHECK(seeker.screen() == screens[25]);
+    CHECK_FALSE(seeker.seek(10));
+    CHECK_FALSE(seeker.seek(screens.size()));
+
+    std::string corrupted{encoded};
+    corrupted[header_size + unchanged_size + 4] ^= 1;
+    std::stringstream corrupted_stream{corrupted};
+    vkchip8::screen_delta_reader corrupted_reader{&corrupted_stream};
+    REQUIRE(corrupted_reader.next());
+    CHECK_THROWS_AS(corrupted_reader.next(), std::runtime_error);
+}
@@ -0,0 +1,41 @@
+#version 450
+
+layout(constant_id = 0) const uint screenWidth = 64;
+layout(constant_id = 1) const uint screenHeight = 32;
+
+layout(std430, binding = 0) readonly buffer Framebuffer {
+    uint words[];
+} framebuffer;
+
+layout(push_constant) uniform PushConstants {
+    uvec2 extent;
+    vec4 color;
+} pc;
+
+layout(location = 0) out vec4 outColor;
+
+const uvec2 screenSize = uvec2(screenWidth, screenHeight);
+
+void main() {
+    // Largest integer scale at which the whole screen fits, centered
+    uint scale = max(1u, min(pc.extent.x / screenSize.x,
+        pc.extent.y / screenSize.y));
+    ivec2 origin = (ivec2(pc.extent) - ivec2(screenSize * scale)) / 2;
+    ivec2 position = ivec2(gl_FragCoord.xy) - origin;
+    if (any(lessThan(position, ivec2(0)))) {
+        discard;
+    }
+
+    uvec2 pixel = uvec2(position) / scale;
+    if (any(greaterThanEqual(pixel, screenSize))) {
+        discard;
+    }
+
+    uint wordsPerRow = (screenSize.x + 31u) / 32u;
+    uint word = framebuffer.words[pixel.y * wordsPerRow + pixel.x / 32u];
+    if (((word >> (pixel.x % 32u)) & 1u) == 0u) {
+        discard;
+    }
+
+    outColor = pc.color;
+}
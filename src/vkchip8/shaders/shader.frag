@@ -1,11 +1,11 @@
 #version 450
 
-layout(binding = 1) uniform UniformBufferObject {
-    vec4 fragColor;
-} ubo;
+layout(push_constant) uniform PushConstants {
+    vec4 color;
+} pc;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = ubo.fragColor;
+    outColor = pc.color;
 }
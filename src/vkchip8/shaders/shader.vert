@@ -1,12 +1,18 @@
 #version 450
 
+layout(constant_id = 0) const uint screenWidth = 64;
+layout(constant_id = 1) const uint screenHeight = 32;
+
 layout(location = 0) in vec2 inPosition;
 layout(location = 1) in vec2 inOffset;
 
-layout(binding = 0) uniform UniformBufferObject {
-    vec2 pixelScale;
-} ubo;
+layout(push_constant) uniform PushConstants {
+    vec4 color;
+    float pixelSize;
+} pc;
 
 void main() {
-    gl_Position = vec4(inPosition * ubo.pixelScale + inOffset, 0.0, 1.0);
+    vec2 cellSize = 2.0 / vec2(screenWidth, screenHeight);
+    gl_Position =
+        vec4(inPosition * pc.pixelSize * cellSize + inOffset, 0.0, 1.0);
 }
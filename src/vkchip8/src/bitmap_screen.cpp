@@ -0,0 +1,237 @@
+#include <bitmap_screen.hpp>
+
+#include <vulkan_buffer.hpp>
+#include <vulkan_deletion_queue.hpp>
+#include <vulkan_device.hpp>
+#include <vulkan_pipeline.hpp>
+#include <vulkan_utility.hpp>
+
+#include <chip8.hpp>
+#include <shaders.hpp>
+
+#include <glm/glm.hpp> // IWYU pragma: keep
+
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    static_assert(vkchip8::chip8::screen_width <= 64,
+        "a row has to fit into unsigned long long");
+
+    constexpr uint32_t words_per_row{(vkchip8::chip8::screen_width + 31) / 32};
+
+    constexpr VkDeviceSize bitmap_size{
+        sizeof(uint32_t) * words_per_row * vkchip8::chip8::screen_height};
+
+    // Matches the push constant block of bitmap.frag
+    struct [[nodiscard]] push_constants final
+    {
+        glm::uvec2 extent;
+        alignas(16) glm::fvec4 color;
+    };
+
+    // Matches the specialization constants of bitmap.frag
+    constexpr uint32_t screen_width_constant{0};
+    constexpr uint32_t screen_height_constant{1};
+
+    [[nodiscard]] VkDescriptorSetLayout create_descriptor_set_layout(
+        vkrndr::vulkan_device* const device)
+    {
+        VkDescriptorSetLayoutBinding bitmap_binding{};
+        bitmap_binding.binding = 0;
+        bitmap_binding.descriptorType =
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        bitmap_binding.descriptorCount = 1;
+        bitmap_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layout_info{};
+        layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layout_info.bindingCount = 1;
+        layout_info.pBindings = &bitmap_binding;
+
+        VkDescriptorSetLayout rv{};
+        if (vkCreateDescriptorSetLayout(device->logical(),
+                &layout_info,
+                nullptr,
+                &rv) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"failed to create descriptor set layout"};
+        }
+
+        return rv;
+    }
+
+    [[nodiscard]] VkDescriptorSet create_descriptor_set(
+        vkrndr::vulkan_device* const device,
+        VkDescriptorSetLayout const layout,
+        VkDescriptorPool const descriptor_pool,
+        VkBuffer const bitmap_buffer)
+    {
+        VkDescriptorSetAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc_info.descriptorPool = descriptor_pool;
+        alloc_info.descriptorSetCount = 1;
+        alloc_info.pSetLayouts = &layout;
+
+        VkDescriptorSet rv{};
+        if (vkAllocateDescriptorSets(device->logical(), &alloc_info, &rv) !=
+            VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate descriptor set!");
+        }
+
+        VkDescriptorBufferInfo buffer_info{};
+        buffer_info.buffer = bitmap_buffer;
+        buffer_info.offset = 0;
+        buffer_info.range = bitmap_size;
+
+        VkWriteDescriptorSet descriptor_write{};
+        descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_write.dstSet = rv;
+        descriptor_write.dstBinding = 0;
+        descriptor_write.dstArrayElement = 0;
+        descriptor_write.descriptorType =
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        descriptor_write.descriptorCount = 1;
+        descriptor_write.pBufferInfo = &buffer_info;
+
+        vkUpdateDescriptorSets(device->logical(),
+            1,
+            &descriptor_write,
+            0,
+            nullptr);
+
+        return rv;
+    }
+} // namespace
+
+vkchip8::bitmap_screen::bitmap_screen(chip8 const* device,
+    std::optional<std::filesystem::path> shader_directory)
+    : device_{device}
+    , shader_directory_{std::move(shader_directory)}
+{
+}
+
+vkchip8::bitmap_screen::~bitmap_screen() { detach_renderer(); }
+
+void vkchip8::bitmap_screen::attach_renderer_impl(VkFormat const image_format,
+    uint32_t const frames_in_flight)
+{
+    descriptor_set_layout_ = create_descriptor_set_layout(vulkan_device_);
+
+    vkrndr::vulkan_pipeline_builder builder{vulkan_device_, image_format};
+    add_shader(builder,
+        VK_SHADER_STAGE_VERTEX_BIT,
+        bitmap_vertex_shader,
+        shader_directory_);
+    add_shader(builder,
+        VK_SHADER_STAGE_FRAGMENT_BIT,
+        bitmap_fragment_shader,
+        shader_directory_);
+    pipeline_ = std::make_unique<vkrndr::vulkan_pipeline>(
+        builder.with_rasterization_samples(vulkan_device_->max_msaa_samples())
+            .add_descriptor_set_layout(descriptor_set_layout_)
+            .add_specialization_constant(VK_SHADER_STAGE_FRAGMENT_BIT,
+                screen_width_constant,
+                uint32_t{chip8::screen_width})
+            .add_specialization_constant(VK_SHADER_STAGE_FRAGMENT_BIT,
+                screen_height_constant,
+                uint32_t{chip8::screen_height})
+            .with_push_constants(VkPushConstantRange{
+                .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .offset = 0,
+                .size = sizeof(push_constants)})
+            .build());
+
+    // Every frame in flight has its own copy of the bitmap at a fixed
+    // offset, so recorded commands stay valid. A single set with a dynamic
+    // offset covers all of them.
+    VkDeviceSize const alignment{vulkan_device_->storage_buffer_alignment()};
+    bitmap_stride_ = (bitmap_size + alignment - 1) / alignment * alignment;
+    bitmap_buffer_ = vkrndr::create_buffer(vulkan_device_,
+        bitmap_stride_ * frames_in_flight,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    bitmap_map_ = static_cast<std::byte*>(vkrndr::map_memory(bitmap_buffer_));
+
+    descriptor_set_ = create_descriptor_set(vulkan_device_,
+        descriptor_set_layout_,
+        descriptor_pool_,
+        bitmap_buffer_.buffer);
+}
+
+void vkchip8::bitmap_screen::update_impl(uint32_t const frame_index) const
+{
+    VkDeviceSize const offset{bitmap_stride_ * frame_index};
+
+    // NOLINTNEXTLINE
+    auto* words{reinterpret_cast<uint32_t*>(bitmap_map_ + offset)};
+    for (auto const& row : device_->screen_data())
+    {
+        auto const bits{row.to_ullong()};
+        for (uint32_t i{}; i != words_per_row; ++i)
+        {
+            *words++ = static_cast<uint32_t>(bits >> (32 * i));
+        }
+    }
+
+    vkrndr::flush_memory(vulkan_device_, bitmap_buffer_, offset, bitmap_size);
+}
+
+void vkchip8::bitmap_screen::render_impl(VkCommandBuffer command_buffer,
+    VkExtent2D const extent,
+    uint32_t const frame_index) const
+{
+    vkCmdBindPipeline(command_buffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipeline_->pipeline());
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+    VkRect2D const scissor{{0, 0}, extent};
+    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+    auto const bitmap_offset{
+        static_cast<uint32_t>(bitmap_stride_ * frame_index)};
+    vkCmdBindDescriptorSets(command_buffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipeline_->pipeline_layout(),
+        0,
+        1,
+        &descriptor_set_,
+        1,
+        &bitmap_offset);
+
+    push_constants const constants{
+        .extent = {extent.width, extent.height},
+        .color = {1.0f, 1.0f, 1.0f, 0.0f}};
+    vkCmdPushConstants(command_buffer,
+        pipeline_->pipeline_layout(),
+        VK_SHADER_STAGE_FRAGMENT_BIT,
+        0,
+        sizeof(constants),
+        &constants);
+
+    vkCmdDraw(command_buffer, 3, 1, 0, 0);
+}
+
+void vkchip8::bitmap_screen::detach_renderer_impl()
+{
+    if (vulkan_device_)
+    {
+        deletion_queue_->push(descriptor_pool_, descriptor_set_);
+
+        deletion_queue_->push(std::move(pipeline_));
+        deletion_queue_->push(descriptor_set_layout_);
+
+        deletion_queue_->push(std::exchange(bitmap_buffer_, {}));
+    }
+}
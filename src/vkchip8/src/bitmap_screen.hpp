@@ -0,0 +1,73 @@
+#ifndef VKCHIP8_BITMAP_SCREEN_INCLUDED
+#define VKCHIP8_BITMAP_SCREEN_INCLUDED
+
+#include <vulkan_buffer.hpp>
+#include <vulkan_render_target.hpp>
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+
+namespace vkchip8
+{
+    class chip8;
+} // namespace vkchip8
+
+namespace vkrndr
+{
+    class vulkan_pipeline;
+} // namespace vkrndr
+
+namespace vkchip8
+{
+    // Uploads the screen as a bitmap with one bit per pixel and expands it
+    // in the fragment shader of a single full screen triangle
+    class [[nodiscard]] bitmap_screen final
+        : public vkrndr::vulkan_render_target
+    {
+    public: // Construction
+        bitmap_screen(chip8 const* device,
+            std::optional<std::filesystem::path> shader_directory);
+
+        bitmap_screen(bitmap_screen const&) = delete;
+
+        bitmap_screen(bitmap_screen&&) noexcept = delete;
+
+    public: // Destruction
+        ~bitmap_screen() override;
+
+    private: // vulkan_render_target implementation
+        void attach_renderer_impl(VkFormat image_format,
+            uint32_t frames_in_flight) override;
+
+        void update_impl(uint32_t frame_index) const override;
+
+        void render_impl(VkCommandBuffer command_buffer,
+            VkExtent2D extent,
+            uint32_t frame_index) const override;
+
+        void detach_renderer_impl() override;
+
+    public: // Operators
+        bitmap_screen& operator=(bitmap_screen const&) = delete;
+
+        bitmap_screen& operator=(bitmap_screen&&) noexcept = delete;
+
+    private: // Data
+        chip8 const* device_{};
+        std::optional<std::filesystem::path> shader_directory_;
+
+        VkDescriptorSetLayout descriptor_set_layout_{};
+        VkDescriptorSet descriptor_set_{};
+        std::unique_ptr<vkrndr::vulkan_pipeline> pipeline_;
+        vkrndr::vulkan_buffer bitmap_buffer_;
+        std::byte* bitmap_map_{};
+        VkDeviceSize bitmap_stride_{};
+    };
+} // namespace vkchip8
+
+#endif // !VKCHIP8_BITMAP_SCREEN_INCLUDED
@@ -0,0 +1,53 @@
+#include <frame_scheduler.hpp>
+
+#include <SDL_timer.h>
+
+#include <algorithm>
+
+vkchip8::frame_scheduler::frame_scheduler(uint32_t const frames_per_second)
+    : frequency_{SDL_GetPerformanceFrequency()}
+    , period_{frequency_ / frames_per_second}
+    , safety_margin_{frequency_ / 1000}
+    , deadline_{SDL_GetPerformanceCounter() + period_}
+{
+}
+
+void vkchip8::frame_scheduler::wait_for_frame_start()
+{
+    uint64_t const budget{
+        std::min(work_estimate_ + safety_margin_, period_)};
+    uint64_t const start{deadline_ - budget};
+
+    // SDL_Delay can oversleep by a millisecond or more, spin for the rest
+    uint64_t const sleep_granularity{2 * frequency_ / 1000};
+    for (uint64_t now{SDL_GetPerformanceCounter()}; now < start;
+         now = SDL_GetPerformanceCounter())
+    {
+        if (start - now > sleep_granularity)
+        {
+            SDL_Delay(static_cast<uint32_t>(
+                (start - now - sleep_granularity) * 1000 / frequency_));
+        }
+    }
+}
+
+void vkchip8::frame_scheduler::begin_frame()
+{
+    frame_start_ = SDL_GetPerformanceCounter();
+}
+
+void vkchip8::frame_scheduler::end_frame()
+{
+    uint64_t const now{SDL_GetPerformanceCounter()};
+
+    // React to slow frames immediately, forget them slowly
+    uint64_t const duration{now - frame_start_};
+    work_estimate_ = std::max(duration, work_estimate_ - work_estimate_ / 16);
+
+    deadline_ += period_;
+    if (deadline_ < now + period_ / 2)
+    {
+        // Fell behind, don't try to catch up with missed frames
+        deadline_ = now + period_;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef VKCHIP8_FRAME_SCHEDULER_INCLUDED
+#define VKCHIP8_FRAME_SCHEDULER_INCLUDED
+
+#include <cstdint>
+
+namespace vkchip8
+{
+    // Starts each frame as late as possible while still finishing it before
+    // the deadline, based on how long recent frames took. Time is measured
+    // with the SDL performance counter.
+    class [[nodiscard]] frame_scheduler final
+    {
+    public: // Construction
+        explicit frame_scheduler(uint32_t frames_per_second);
+
+        frame_scheduler(frame_scheduler const&) = default;
+
+        frame_scheduler(frame_scheduler&&) noexcept = default;
+
+    public: // Destruction
+        ~frame_scheduler() = default;
+
+    public: // Interface
+        // Sleeps until the latest moment at which the next frame can start
+        void wait_for_frame_start();
+
+        void begin_frame();
+
+        // Called once the CPU work of the frame is done, before waiting for
+        // the swap chain, so only that work feeds the estimate
+        void end_frame();
+
+        // Expected duration of a frame, in performance counter ticks
+        [[nodiscard]] constexpr uint64_t work_estimate() const noexcept;
+
+    public: // Operators
+        frame_scheduler& operator=(frame_scheduler const&) = default;
+
+        frame_scheduler& operator=(frame_scheduler&&) noexcept = default;
+
+    private: // Data
+        uint64_t frequency_{};
+        uint64_t period_{};
+        uint64_t safety_margin_{};
+        uint64_t deadline_{};
+        uint64_t frame_start_{};
+        uint64_t work_estimate_{};
+    };
+} // namespace vkchip8
+
+inline constexpr uint64_t
+vkchip8::frame_scheduler::work_estimate() const noexcept
+{
+    return work_estimate_;
+}
+
+#endif // !VKCHIP8_FRAME_SCHEDULER_INCLUDED
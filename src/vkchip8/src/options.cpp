@@ -0,0 +1,200 @@
+#include <options.hpp>
+
+#include <fmt/format.h>
+
+#include <charconv>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+namespace
+{
+    [[nodiscard]] std::string_view next_argument(
+        std::span<char const* const> arguments,
+        size_t& index)
+    {
+        std::string_view const name{arguments[index]};
+        if (++index == arguments.size())
+        {
+            throw std::runtime_error{
+                fmt::format("missing value for option {}", name)};
+        }
+        return arguments[index];
+    }
+
+    template<typename T>
+    [[nodiscard]] T parse_number(std::string_view const value)
+    {
+        T rv{};
+        auto const [end, error]{
+            std::from_chars(value.data(), value.data() + value.size(), rv)};
+        if (error != std::errc{} || end != value.data() + value.size())
+        {
+            throw std::runtime_error{
+                fmt::format("invalid numeric value {}", value)};
+        }
+        return rv;
+    }
+} // namespace
+
+vkchip8::options vkchip8::parse_options(int const argc,
+    char const* const* const argv)
+{
+    std::span<char const* const> const arguments{argv,
+        static_cast<size_t>(argc)};
+
+    options rv;
+    for (size_t i{1}; i < arguments.size(); ++i)
+    {
+        std::string_view const argument{arguments[i]};
+        if (argument == "--record")
+        {
+            rv.record_movie = next_argument(arguments, i);
+        }
+        else if (argument == "--replay")
+        {
+            rv.replay_movie = next_argument(arguments, i);
+        }
+        else if (argument == "--seek")
+        {
+            rv.seek_frame =
+                parse_number<uint64_t>(next_argument(arguments, i));
+        }
+        else if (argument == "--keyframe-interval")
+        {
+            rv.keyframe_interval =
+                parse_number<uint32_t>(next_argument(arguments, i));
+        }
+        else if (argument == "--rewind-seconds")
+        {
+            rv.rewind_seconds =
+                parse_number<uint32_t>(next_argument(arguments, i));
+        }
+        else if (argument == "--run-ahead")
+        {
+            rv.run_ahead = parse_number<uint32_t>(next_argument(arguments, i));
+        }
+        else if (argument == "--renderer")
+        {
+            auto const value{next_argument(arguments, i)};
+            if (value == "instanced")
+            {
+                rv.renderer = screen_renderer::instanced;
+            }
+            else if (value == "bitmap")
+            {
+                rv.renderer = screen_renderer::bitmap;
+            }
+            else
+            {
+                throw std::runtime_error{
+                    fmt::format("unknown renderer {}", value)};
+            }
+        }
+        else if (argument == "--frames-in-flight")
+        {
+            rv.frames_in_flight =
+                parse_number<uint32_t>(next_argument(arguments, i));
+        }
+        else if (argument == "--image-count")
+        {
+            rv.image_count =
+                parse_number<uint32_t>(next_argument(arguments, i));
+        }
+        else if (argument == "--present-mode")
+        {
+            auto const value{next_argument(arguments, i)};
+            if (value == "fifo")
+            {
+                rv.presentation = present_mode::fifo;
+            }
+            else if (value == "fifo-relaxed")
+            {
+                rv.presentation = present_mode::fifo_relaxed;
+            }
+            else if (value == "mailbox")
+            {
+                rv.presentation = present_mode::mailbox;
+            }
+            else if (value == "immediate")
+            {
+                rv.presentation = present_mode::immediate;
+            }
+            else
+            {
+                throw std::runtime_error{
+                    fmt::format("unknown present mode {}", value)};
+            }
+        }
+        else if (argument == "--shader-dir")
+        {
+            rv.shader_directory = next_argument(arguments, i);
+        }
+        else if (argument == "--thumbnail")
+        {
+            rv.thumbnail = next_argument(arguments, i);
+        }
+        else if (argument == "--capture")
+        {
+            rv.capture = next_argument(arguments, i);
+        }
+        else if (argument == "--screen-deltas")
+        {
+            rv.screen_deltas = next_argument(arguments, i);
+        }
+        else if (argument == "--trace")
+        {
+            rv.trace = next_argument(arguments, i);
+        }
+        else if (argument == "--export")
+        {
+            rv.shared_export = next_argument(arguments, i);
+        }
+        else if (argument == "--headless")
+        {
+            rv.headless = true;
+        }
+        else if (argument.starts_with("--") || !rv.rom.empty())
+        {
+            throw std::runtime_error{
+                fmt::format("unrecognized argument {}", argument)};
+        }
+        else
+        {
+            rv.rom = argument;
+        }
+    }
+
+    if (rv.record_movie && rv.replay_movie)
+    {
+        throw std::runtime_error{"can't record and replay at the same time"};
+    }
+
+    if (rv.headless && !rv.replay_movie)
+    {
+        throw std::runtime_error{"headless mode requires a movie to replay"};
+    }
+
+    if (rv.thumbnail && !rv.headless)
+    {
+        throw std::runtime_error{"thumbnails require headless mode"};
+    }
+
+    if (rv.capture && rv.headless)
+    {
+        throw std::runtime_error{"video capture requires a window"};
+    }
+
+    if (rv.frames_in_flight == 0)
+    {
+        throw std::runtime_error{"at least one frame has to be in flight"};
+    }
+
+    if (rv.rom.empty() && !rv.replay_movie)
+    {
+        throw std::runtime_error{"no ROM file specified"};
+    }
+
+    return rv;
+}
@@ -0,0 +1,60 @@
+#ifndef VKCHIP8_OPTIONS_INCLUDED
+#define VKCHIP8_OPTIONS_INCLUDED
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace vkchip8
+{
+    enum class screen_renderer : uint8_t
+    {
+        instanced,
+        bitmap
+    };
+
+    enum class present_mode : uint8_t
+    {
+        fifo,
+        fifo_relaxed,
+        mailbox,
+        immediate
+    };
+
+    struct [[nodiscard]] options final
+    {
+        std::filesystem::path rom;
+        std::optional<std::filesystem::path> record_movie;
+        std::optional<std::filesystem::path> replay_movie;
+        std::optional<uint64_t> seek_frame;
+        std::optional<std::filesystem::path> shader_directory;
+        std::optional<std::filesystem::path> thumbnail;
+        std::optional<std::filesystem::path> capture;
+        std::optional<std::filesystem::path> screen_deltas;
+        std::optional<std::string> shared_export;
+        // Written when requested from the profiler window
+        std::filesystem::path trace{"vkchip8.trace.json"};
+        uint32_t keyframe_interval{60};
+        uint32_t rewind_seconds{300};
+        uint32_t run_ahead{};
+        uint32_t frames_in_flight{2};
+        std::optional<uint32_t> image_count;
+        present_mode presentation{present_mode::mailbox};
+        screen_renderer renderer{screen_renderer::instanced};
+        bool headless{};
+    };
+
+    // Usage: vkchip8 [ROM] [--record MOVIE |
+    //          --replay MOVIE [--headless [--thumbnail FILE]]]
+    //          [--seek FRAME] [--keyframe-interval FRAMES]
+    //          [--rewind-seconds SECONDS] [--run-ahead FRAMES]
+    //          [--renderer instanced|bitmap] [--shader-dir DIRECTORY]
+    //          [--capture FILE] [--screen-deltas FILE] [--export NAME]
+    //          [--trace FILE]
+    //          [--frames-in-flight FRAMES] [--image-count IMAGES]
+    //          [--present-mode fifo|fifo-relaxed|mailbox|immediate]
+    options parse_options(int argc, char const* const* argv);
+} // namespace vkchip8
+
+#endif // !VKCHIP8_OPTIONS_INCLUDED
@@ -0,0 +1,162 @@
+#include <profiler_window.hpp>
+
+#include <cpu_profiler.hpp>
+
+#include <fmt/format.h>
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string_view>
+#include <utility>
+
+namespace
+{
+    [[nodiscard]] float milliseconds(uint64_t const nanoseconds)
+    {
+        return static_cast<float>(static_cast<double>(nanoseconds) / 1e6);
+    }
+
+    [[nodiscard]] ImU32 zone_color(char const* const name)
+    {
+        auto const hash{std::hash<std::string_view>{}(name)};
+        return ImColor::HSV(static_cast<float>(hash % 360) / 360.0f,
+            0.5f,
+            0.7f);
+    }
+
+    // Zones of each thread are drawn below the zones of the previous one,
+    // nested zones below the zone they are nested in
+    void draw_flame_graph(vkrndr::cpu_frame const& frame)
+    {
+        std::map<uint32_t, uint32_t> first_row;
+        for (vkrndr::cpu_zone const& zone : frame.zones)
+        {
+            auto& rows{first_row[zone.thread]};
+            rows = std::max(rows, zone.depth + 1);
+        }
+        uint32_t row_count{};
+        for (auto& entry : first_row)
+        {
+            row_count += std::exchange(entry.second, row_count);
+        }
+
+        float const row_height{ImGui::GetTextLineHeightWithSpacing()};
+        float const width{std::max(ImGui::GetContentRegionAvail().x, 1.0f)};
+        ImVec2 const origin{ImGui::GetCursorScreenPos()};
+        ImGui::InvisibleButton("##flame_graph",
+            ImVec2{width,
+                row_height * static_cast<float>(std::max(row_count, 1u))});
+        bool const hovered{ImGui::IsItemHovered()};
+
+        auto const duration{static_cast<double>(
+            std::max(frame.end - frame.begin, uint64_t{1}))};
+        auto const position = [&frame, duration, width](uint64_t const time)
+        {
+            auto const offset{static_cast<double>(
+                std::clamp(time, frame.begin, frame.end) - frame.begin)};
+            return static_cast<float>(offset / duration) * width;
+        };
+
+        ImDrawList* const draw_list{ImGui::GetWindowDrawList()};
+        for (vkrndr::cpu_zone const& zone : frame.zones)
+        {
+            float const row{
+                static_cast<float>(first_row[zone.thread] + zone.depth)};
+            ImVec2 const min{origin.x + position(zone.begin),
+                origin.y + row * row_height};
+            ImVec2 const max{
+                std::max(origin.x + position(zone.end), min.x + 1.0f),
+                min.y + row_height - 1.0f};
+
+            draw_list->AddRectFilled(min, max, zone_color(zone.name));
+            if (ImGui::CalcTextSize(zone.name).x < max.x - min.x - 4.0f)
+            {
+                draw_list->AddText(ImVec2{min.x + 2.0f, min.y},
+                    IM_COL32_WHITE,
+                    zone.name);
+            }
+
+            if (hovered && ImGui::IsMouseHoveringRect(min, max))
+            {
+                ImGui::SetTooltip("%s: %.3f ms",
+                    zone.name,
+                    static_cast<double>(milliseconds(zone.end - zone.begin)));
+            }
+        }
+    }
+} // namespace
+
+vkchip8::profiler_window::profiler_window(std::filesystem::path trace_file)
+    : trace_file_{std::move(trace_file)}
+{
+}
+
+void vkchip8::profiler_window::draw(vkrndr::cpu_profiler const& profiler)
+{
+    ImGui::Begin("CPU profile");
+
+    auto const& frames{profiler.frames()};
+    if (frames.empty())
+    {
+        ImGui::TextUnformatted("Waiting for frames");
+        ImGui::End();
+        return;
+    }
+
+    frame_times_.clear();
+    for (vkrndr::cpu_frame const& frame : frames)
+    {
+        frame_times_.push_back(milliseconds(frame.end - frame.begin));
+    }
+    auto const slowest{std::ranges::max_element(frame_times_)};
+
+    ImGui::Text("Frame: %.2f ms, slowest: %.2f ms",
+        static_cast<double>(frame_times_.back()),
+        static_cast<double>(*slowest));
+    ImGui::PlotHistogram("##frame_times",
+        frame_times_.data(),
+        static_cast<int>(frame_times_.size()),
+        0,
+        nullptr,
+        0.0f,
+        std::max(*slowest, 1000.0f / 30.0f),
+        ImVec2{0, 80});
+
+    ImGui::Checkbox("Slowest frame", &show_slowest_);
+    draw_flame_graph(show_slowest_
+            ? frames[static_cast<size_t>(slowest - frame_times_.begin())]
+            : frames.back());
+
+    if (ImGui::Button("Save trace"))
+    {
+        save_trace(profiler);
+    }
+    ImGui::SameLine();
+    ImGui::TextUnformatted(status_.c_str());
+
+    if (uint64_t const dropped{profiler.dropped_zones()}; dropped != 0)
+    {
+        ImGui::Text("Dropped zones: %llu",
+            static_cast<unsigned long long>(dropped));
+    }
+
+    ImGui::End();
+}
+
+void vkchip8::profiler_window::save_trace(vkrndr::cpu_profiler const& profiler)
+{
+    std::ofstream stream{trace_file_, std::ios::trunc};
+    if (stream)
+    {
+        profiler.write_chrome_trace(stream);
+    }
+
+    status_ = stream.flush()
+        ? fmt::format("Saved {}", trace_file_.string())
+        : fmt::format("Failed to write {}", trace_file_.string());
+}
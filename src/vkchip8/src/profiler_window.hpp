@@ -0,0 +1,50 @@
+#ifndef VKCHIP8_PROFILER_WINDOW_INCLUDED
+#define VKCHIP8_PROFILER_WINDOW_INCLUDED
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace vkrndr
+{
+    class cpu_profiler;
+    struct cpu_frame;
+} // namespace vkrndr
+
+namespace vkchip8
+{
+    // ImGui window with the times of frames retained by a CPU profiler and
+    // a flame graph of the latest or the slowest one. The frames can be
+    // saved as a Chrome trace to trace_file.
+    class [[nodiscard]] profiler_window final
+    {
+    public: // Construction
+        explicit profiler_window(std::filesystem::path trace_file);
+
+        profiler_window(profiler_window const&) = delete;
+
+        profiler_window(profiler_window&&) noexcept = delete;
+
+    public: // Destruction
+        ~profiler_window() = default;
+
+    public: // Interface
+        void draw(vkrndr::cpu_profiler const& profiler);
+
+    public: // Operators
+        profiler_window& operator=(profiler_window const&) = delete;
+
+        profiler_window& operator=(profiler_window&&) noexcept = delete;
+
+    private: // Helpers
+        void save_trace(vkrndr::cpu_profiler const& profiler);
+
+    private: // Data
+        std::filesystem::path trace_file_;
+        bool show_slowest_{};
+        std::string status_;
+        std::vector<float> frame_times_;
+    };
+} // namespace vkchip8
+
+#endif // !VKCHIP8_PROFILER_WINDOW_INCLUDED
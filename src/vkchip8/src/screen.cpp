@@ -1,169 +1,33 @@
 #include <screen.hpp>
 
+#include <vulkan_buffer.hpp>
+#include <vulkan_deletion_queue.hpp>
 #include <vulkan_device.hpp>
 #include <vulkan_pipeline.hpp>
+#include <vulkan_uploader.hpp>
 #include <vulkan_utility.hpp>
 
 #include <chip8.hpp>
+#include <shaders.hpp>
 
 #include <array>
-#include <cstring>
+#include <bit>
+#include <cstddef>
+#include <optional>
+#include <utility>
 
 namespace
 {
-    [[nodiscard]] VkDescriptorSetLayout create_descriptor_set_layout(
-        vkrndr::vulkan_device* const device)
+    // Matches the push constant blocks of shader.vert and shader.frag
+    struct [[nodiscard]] push_constants final
     {
-        VkDescriptorSetLayoutBinding vertex_uniform_binding{};
-        vertex_uniform_binding.binding = 0;
-        vertex_uniform_binding.descriptorType =
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        vertex_uniform_binding.descriptorCount = 1;
-        vertex_uniform_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-        VkDescriptorSetLayoutBinding fragment_uniform_binding{};
-        fragment_uniform_binding.binding = 1;
-        fragment_uniform_binding.descriptorType =
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        fragment_uniform_binding.descriptorCount = 1;
-        fragment_uniform_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-        std::array bindings{vertex_uniform_binding, fragment_uniform_binding};
-
-        VkDescriptorSetLayoutCreateInfo layout_info{};
-        layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layout_info.bindingCount = vkrndr::count_cast(bindings.size());
-        layout_info.pBindings = bindings.data();
-
-        VkDescriptorSetLayout rv{};
-        if (vkCreateDescriptorSetLayout(device->logical(),
-                &layout_info,
-                nullptr,
-                &rv) != VK_SUCCESS)
-        {
-            throw std::runtime_error{"failed to create descriptor set layout"};
-        }
-
-        return rv;
-    }
-
-    [[nodiscard]] std::tuple<VkBuffer, VkDeviceMemory> create_buffer(
-        vkrndr::vulkan_device* const device,
-        VkDeviceSize const size,
-        VkBufferCreateFlags const usage,
-        VkMemoryPropertyFlags const memory_properties)
-    {
-        VkBufferCreateInfo buffer_info{};
-        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        buffer_info.size = size;
-        buffer_info.usage = usage;
-        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        VkBuffer buffer;
-        if (vkCreateBuffer(device->logical(), &buffer_info, nullptr, &buffer) !=
-            VK_SUCCESS)
-        {
-            throw std::runtime_error{"failed to create buffer!"};
-        }
-
-        VkMemoryRequirements memory_requirements{};
-        vkGetBufferMemoryRequirements(device->logical(),
-            buffer,
-            &memory_requirements);
-
-        VkMemoryAllocateInfo alloc_info{};
-        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        alloc_info.allocationSize = memory_requirements.size;
-        alloc_info.memoryTypeIndex =
-            vkrndr::find_memory_type(device->physical(),
-                memory_requirements.memoryTypeBits,
-                memory_properties);
-
-        VkDeviceMemory device_memory;
-        if (vkAllocateMemory(device->logical(),
-                &alloc_info,
-                nullptr,
-                &device_memory) != VK_SUCCESS)
-        {
-            throw std::runtime_error{"failed to allocate buffer memory!"};
-        }
-
-        if (vkBindBufferMemory(device->logical(), buffer, device_memory, 0) !=
-            VK_SUCCESS)
-        {
-            throw std::runtime_error{"failed to bind buffer memory!"};
-        }
-
-        return {buffer, device_memory};
-    }
-
-    [[nodiscard]] VkDescriptorSet create_descriptor_set(
-        vkrndr::vulkan_device* const device,
-        VkDescriptorSetLayout const layout,
-        VkDescriptorPool const descriptor_pool)
-    {
-        VkDescriptorSetAllocateInfo alloc_info{};
-        alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        alloc_info.descriptorPool = descriptor_pool;
-        alloc_info.descriptorSetCount = 1;
-        alloc_info.pSetLayouts = &layout;
-
-        VkDescriptorSet descriptor_set{};
-        if (vkAllocateDescriptorSets(device->logical(),
-                &alloc_info,
-                &descriptor_set) != VK_SUCCESS)
-        {
-            throw std::runtime_error("failed to allocate descriptor set!");
-        }
+        glm::fvec4 color;
+        float pixel_size;
+    };
 
-        return descriptor_set;
-    }
-
-    void bind_descriptor_set(vkrndr::vulkan_device* const device,
-        VkDescriptorSet const& descriptor_set,
-        VkBuffer const vertex_buffer,
-        VkBuffer const fragment_buffer)
-    {
-        VkDescriptorBufferInfo vertex_buffer_info{};
-        vertex_buffer_info.buffer = vertex_buffer;
-        vertex_buffer_info.offset = 0;
-        vertex_buffer_info.range = VK_WHOLE_SIZE;
-
-        VkWriteDescriptorSet vertex_descriptor_write{};
-        vertex_descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        vertex_descriptor_write.dstSet = descriptor_set;
-        vertex_descriptor_write.dstBinding = 0;
-        vertex_descriptor_write.dstArrayElement = 0;
-        vertex_descriptor_write.descriptorType =
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        vertex_descriptor_write.descriptorCount = 1;
-        vertex_descriptor_write.pBufferInfo = &vertex_buffer_info;
-
-        VkDescriptorBufferInfo fragment_buffer_info{};
-        fragment_buffer_info.buffer = fragment_buffer;
-        fragment_buffer_info.offset = 0;
-        fragment_buffer_info.range = VK_WHOLE_SIZE;
-
-        VkWriteDescriptorSet fragment_descriptor_write{};
-        fragment_descriptor_write.sType =
-            VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        fragment_descriptor_write.dstSet = descriptor_set;
-        fragment_descriptor_write.dstBinding = 1;
-        fragment_descriptor_write.dstArrayElement = 0;
-        fragment_descriptor_write.descriptorType =
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        fragment_descriptor_write.descriptorCount = 1;
-        fragment_descriptor_write.pBufferInfo = &fragment_buffer_info;
-
-        std::array descriptor_writes{vertex_descriptor_write,
-            fragment_descriptor_write};
-
-        vkUpdateDescriptorSets(device->logical(),
-            vkrndr::count_cast(descriptor_writes.size()),
-            descriptor_writes.data(),
-            0,
-            nullptr);
-    }
+    // Matches the specialization constants of shader.vert
+    constexpr uint32_t screen_width_constant{0};
+    constexpr uint32_t screen_height_constant{1};
 
     [[nodiscard]] constexpr auto binding_description()
     {
@@ -195,11 +59,18 @@ namespace
     }
 } // namespace
 
-vkchip8::screen::screen(chip8* device)
+vkchip8::screen::screen(chip8 const* device,
+    std::optional<std::filesystem::path> shader_directory)
     : device_{device}
-    , vertices_{{0, 0}, {.95f, 0}, {.95f, .95f}, {0, .95f}}
+    , shader_directory_{std::move(shader_directory)}
+    , vertices_{{0, 0}, {1, 0}, {1, 1}, {0, 1}}
     , indices_{0, 1, 2, 2, 3, 0}
 {
+    for (size_t i{}; i != column_offsets_.size(); ++i)
+    {
+        column_offsets_[i] =
+            -1 + 2.f / chip8::screen_width * static_cast<float>(i);
+    }
 }
 
 vkchip8::screen::~screen() { detach_renderer(); }
@@ -207,149 +78,128 @@ vkchip8::screen::~screen() { detach_renderer(); }
 void vkchip8::screen::attach_renderer_impl(VkFormat const image_format,
     uint32_t const frames_in_flight)
 {
-    descriptor_set_layout_ = create_descriptor_set_layout(vulkan_device_);
-
+    vkrndr::vulkan_pipeline_builder builder{vulkan_device_, image_format};
+    add_shader(builder,
+        VK_SHADER_STAGE_VERTEX_BIT,
+        screen_vertex_shader,
+        shader_directory_);
+    add_shader(builder,
+        VK_SHADER_STAGE_FRAGMENT_BIT,
+        screen_fragment_shader,
+        shader_directory_);
     pipeline_ = std::make_unique<vkrndr::vulkan_pipeline>(
-        vkrndr::vulkan_pipeline_builder{vulkan_device_, image_format}
-            .add_shader(VK_SHADER_STAGE_VERTEX_BIT, "vert.spv", "main")
-            .add_shader(VK_SHADER_STAGE_FRAGMENT_BIT, "frag.spv", "main")
-            .with_rasterization_samples(vulkan_device_->max_msaa_samples())
+        builder.with_rasterization_samples(vulkan_device_->max_msaa_samples())
             .add_vertex_input(binding_description(), attribute_descriptions())
-            .add_descriptor_set_layout(descriptor_set_layout_)
+            .add_specialization_constant(VK_SHADER_STAGE_VERTEX_BIT,
+                screen_width_constant,
+                uint32_t{chip8::screen_width})
+            .add_specialization_constant(VK_SHADER_STAGE_VERTEX_BIT,
+                screen_height_constant,
+                uint32_t{chip8::screen_height})
+            .with_push_constants(VkPushConstantRange{
+                .stageFlags =
+                    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                .offset = 0,
+                .size = sizeof(push_constants)})
             .build());
 
-    VkDeviceSize const vert_index_size{vertices_.size() * sizeof(vertices_[0]) +
-        indices_.size() * sizeof(indices_[0])};
-    std::tie(vert_index_buffer_, vert_index_memory_) = create_buffer(
-        vulkan_device_,
-        vert_index_size,
+    // Static geometry is copied to device local memory once
+    auto const vertex_bytes{vkrndr::as_bytes(vertices_)};
+    auto const index_bytes{vkrndr::as_bytes(indices_)};
+    std::vector<std::byte> vert_index_data(vertex_bytes.begin(),
+        vertex_bytes.end());
+    vert_index_data.insert(vert_index_data.end(),
+        index_bytes.begin(),
+        index_bytes.end());
+    vert_index_buffer_ = uploader_->create_buffer(
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    {
-        void* data{};
-        vkMapMemory(vulkan_device_->logical(),
-            vert_index_memory_,
-            0,
-            vert_index_size,
-            0,
-            &data);
-
-        std::byte* const index_memory_start{
-            std::copy_n(reinterpret_cast<std::byte*>(vertices_.data()),
-                vertices_.size() * sizeof(vertices_[0]),
-                reinterpret_cast<std::byte*>(data))};
-
-        std::copy_n(reinterpret_cast<std::byte*>(indices_.data()),
-            indices_.size() * sizeof(indices_[0]),
-            index_memory_start);
-
-        vkUnmapMemory(vulkan_device_->logical(), vert_index_memory_);
-    }
+        vert_index_data);
 
+    // Instance buffers are updated in place every frame and stay mapped
+    // until the renderer is detached
     frame_data_.resize(frames_in_flight);
-    for (uint32_t i{}; i != frames_in_flight; ++i)
+    for (frame_data& data : frame_data_)
     {
-        frame_data& data{frame_data_[i]};
-        std::tie(data.instance_buffer_, data.instance_memory_) =
-            create_buffer(vulkan_device_,
-                sizeof(glm::fvec2) * chip8::screen_width * chip8::screen_width,
-                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        std::tie(data.vertex_uniform_buffer_, data.vertex_uniform_memory_) =
-            create_buffer(vulkan_device_,
-                sizeof(glm::fvec2),
-                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        std::tie(data.fragment_uniform_buffer_, data.fragment_uniform_memory_) =
-            create_buffer(vulkan_device_,
-                sizeof(glm::fvec2),
-                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        data.descriptor_set_ = create_descriptor_set(vulkan_device_,
-            descriptor_set_layout_,
-            descriptor_pool_);
-
-        bind_descriptor_set(vulkan_device_,
-            data.descriptor_set_,
-            data.vertex_uniform_buffer_,
-            data.fragment_uniform_buffer_);
+        data.instance_buffer_ = vkrndr::create_buffer(vulkan_device_,
+            sizeof(glm::fvec2) * chip8::screen_width * chip8::screen_height,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        data.instance_map_ =
+            static_cast<glm::fvec2*>(vkrndr::map_memory(data.instance_buffer_));
+
+        data.indirect_buffer_ = vkrndr::create_buffer(vulkan_device_,
+            sizeof(VkDrawIndexedIndirectCommand) * chip8::screen_height,
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        data.indirect_map_ = static_cast<VkDrawIndexedIndirectCommand*>(
+            vkrndr::map_memory(data.indirect_buffer_));
+        for (uint32_t i{}; i != chip8::screen_height; ++i)
+        {
+            std::construct_at(data.indirect_map_ + i,
+                VkDrawIndexedIndirectCommand{
+                    .indexCount = vkrndr::count_cast(indices_.size()),
+                    .instanceCount = 0,
+                    .firstIndex = 0,
+                    .vertexOffset = 0,
+                    .firstInstance = i * uint32_t{chip8::screen_width}});
+        }
+        vkrndr::flush_memory(vulkan_device_,
+            data.indirect_buffer_,
+            sizeof(VkDrawIndexedIndirectCommand) * chip8::screen_height);
     }
 }
 
-void vkchip8::screen::render_impl(VkCommandBuffer command_buffer,
-    VkExtent2D const extent,
-    uint32_t const frame_index) const
+void vkchip8::screen::update_impl(uint32_t const frame_index) const
 {
-    glm::fvec2 const pixel_scale{2.f / chip8::screen_width,
-        2.f / chip8::screen_height};
-    {
-        void* data{};
-        vkMapMemory(vulkan_device_->logical(),
-            frame_data_[frame_index].vertex_uniform_memory_,
-            0,
-            sizeof(glm::fvec2),
-            0,
-            &data);
-
-        memcpy(data, &pixel_scale, sizeof(pixel_scale));
-
-        vkUnmapMemory(vulkan_device_->logical(),
-            frame_data_[frame_index].vertex_uniform_memory_);
-    }
+    constexpr float row_height{2.f / chip8::screen_height};
 
-    {
-        void* data{};
-        vkMapMemory(vulkan_device_->logical(),
-            frame_data_[frame_index].fragment_uniform_memory_,
-            0,
-            sizeof(glm::fvec2),
-            0,
-            &data);
-
-        glm::fvec4 pixel_color{1.0f, 1.0f, 1.0f, 0.0f};
-        memcpy(data, &pixel_color, sizeof(pixel_color));
-
-        vkUnmapMemory(vulkan_device_->logical(),
-            frame_data_[frame_index].fragment_uniform_memory_);
-    }
-
-    uint32_t on_pixels{};
-
-    void* data{};
-    vkMapMemory(vulkan_device_->logical(),
-        frame_data_[frame_index].instance_memory_,
-        0,
-        sizeof(glm::fvec2) * chip8::screen_width * chip8::screen_width,
-        0,
-        &data);
-    glm::fvec2* instance_offsets{reinterpret_cast<glm::fvec2*>(data)};
+    frame_data const& data{frame_data_[frame_index]};
 
+    // Only rows which differ from what this frame's buffer already holds
+    // are regenerated, walking the set bits of each row
+    std::optional<size_t> last_changed_row;
     auto const& screen_data{device_->screen_data()};
     for (size_t i{}; i != screen_data.size(); ++i)
     {
-        for (size_t j{}; j != screen_data[i].size(); ++j)
+        uint64_t const row{screen_data[i].to_ullong()};
+        if (row == data.rows_[i])
+        {
+            continue;
+        }
+
+        float const y{-1 + row_height * static_cast<float>(i)};
+        glm::fvec2* instance_offsets{
+            data.instance_map_ + i * chip8::screen_width};
+        for (uint64_t bits{row}; bits != 0; bits &= bits - 1)
         {
-            if (screen_data[i].test(j))
-            {
-                std::construct_at(instance_offsets++,
-                    -1 + pixel_scale.x * static_cast<float>(j),
-                    -1 + pixel_scale.y * static_cast<float>(i));
-
-                ++on_pixels;
-            }
+            std::construct_at(instance_offsets++,
+                column_offsets_[static_cast<size_t>(std::countr_zero(bits))],
+                y);
         }
+
+        data.indirect_map_[i].instanceCount =
+            vkrndr::count_cast(std::popcount(row));
+
+        data.rows_[i] = row;
+        last_changed_row = i;
     }
 
-    vkUnmapMemory(vulkan_device_->logical(),
-        frame_data_[frame_index].instance_memory_);
+    if (last_changed_row)
+    {
+        vkrndr::flush_memory(vulkan_device_,
+            data.instance_buffer_,
+            sizeof(glm::fvec2) * chip8::screen_width * (*last_changed_row + 1));
+        vkrndr::flush_memory(vulkan_device_,
+            data.indirect_buffer_,
+            sizeof(VkDrawIndexedIndirectCommand) * (*last_changed_row + 1));
+    }
+}
+
+void vkchip8::screen::render_impl(VkCommandBuffer command_buffer,
+    VkExtent2D const extent,
+    uint32_t const frame_index) const
+{
+    frame_data const& data{frame_data_[frame_index]};
 
     vkCmdBindPipeline(command_buffer,
         VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -360,17 +210,17 @@ void vkchip8::screen::render_impl(VkCommandBuffer command_buffer,
     vkCmdBindVertexBuffers(command_buffer,
         0,
         1,
-        &vert_index_buffer_,
+        &vert_index_buffer_.buffer,
         &vertex_offsets);
     vkCmdBindIndexBuffer(command_buffer,
-        vert_index_buffer_,
+        vert_index_buffer_.buffer,
         index_offset,
         VK_INDEX_TYPE_UINT16);
 
     vkCmdBindVertexBuffers(command_buffer,
         1,
         1,
-        &frame_data_[frame_index].instance_buffer_,
+        &data.instance_buffer_.buffer,
         &vertex_offsets);
 
     VkViewport viewport{};
@@ -385,21 +235,21 @@ void vkchip8::screen::render_impl(VkCommandBuffer command_buffer,
     VkRect2D const scissor{{0, 0}, extent};
     vkCmdSetScissor(command_buffer, 0, 1, &scissor);
 
-    vkCmdBindDescriptorSets(command_buffer,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
+    push_constants const constants{.color = {1.0f, 1.0f, 1.0f, 0.0f},
+        .pixel_size = .95f};
+    vkCmdPushConstants(command_buffer,
         pipeline_->pipeline_layout(),
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
         0,
-        1,
-        &frame_data_[frame_index].descriptor_set_,
-        0,
-        nullptr);
+        sizeof(constants),
+        &constants);
 
-    vkCmdDrawIndexed(command_buffer,
-        vkrndr::count_cast(indices_.size()),
-        on_pixels,
-        0,
+    // Instance counts of the rows are written by update
+    vkCmdDrawIndexedIndirect(command_buffer,
+        data.indirect_buffer_.buffer,
         0,
-        0);
+        vkrndr::count_cast(chip8::screen_height),
+        sizeof(VkDrawIndexedIndirectCommand));
 }
 
 void vkchip8::screen::detach_renderer_impl()
@@ -408,39 +258,13 @@ void vkchip8::screen::detach_renderer_impl()
     {
         for (auto& data : frame_data_)
         {
-            vkFreeDescriptorSets(vulkan_device_->logical(),
-                descriptor_pool_,
-                1,
-                &data.descriptor_set_);
-
-            vkDestroyBuffer(vulkan_device_->logical(),
-                data.instance_buffer_,
-                nullptr);
-            vkFreeMemory(vulkan_device_->logical(),
-                data.instance_memory_,
-                nullptr);
-
-            vkDestroyBuffer(vulkan_device_->logical(),
-                data.vertex_uniform_buffer_,
-                nullptr);
-            vkFreeMemory(vulkan_device_->logical(),
-                data.vertex_uniform_memory_,
-                nullptr);
-
-            vkDestroyBuffer(vulkan_device_->logical(),
-                data.fragment_uniform_buffer_,
-                nullptr);
-            vkFreeMemory(vulkan_device_->logical(),
-                data.fragment_uniform_memory_,
-                nullptr);
+            deletion_queue_->push(data.instance_buffer_);
+            deletion_queue_->push(data.indirect_buffer_);
         }
+        frame_data_.clear();
 
-        pipeline_.reset();
-        vkDestroyDescriptorSetLayout(vulkan_device_->logical(),
-            descriptor_set_layout_,
-            nullptr);
+        deletion_queue_->push(std::move(pipeline_));
 
-        vkDestroyBuffer(vulkan_device_->logical(), vert_index_buffer_, nullptr);
-        vkFreeMemory(vulkan_device_->logical(), vert_index_memory_, nullptr);
+        deletion_queue_->push(std::exchange(vert_index_buffer_, {}));
     }
 }
@@ -1,20 +1,22 @@
 #ifndef VKCHIP8_SCREEN_INCLUDED
 #define VKCHIP8_SCREEN_INCLUDED
 
+#include <vulkan_buffer.hpp>
 #include <vulkan_render_target.hpp>
 
+#include <chip8.hpp>
+
 #include <vulkan/vulkan_core.h>
 
 #include <glm/glm.hpp> // IWYU pragma: keep
 
+#include <array>
+#include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <vector>
 
-namespace vkchip8
-{
-    class chip8;
-} // namespace vkchip8
-
 namespace vkrndr
 {
     class vulkan_pipeline;
@@ -25,7 +27,8 @@ namespace vkchip8
     class [[nodiscard]] screen final : public vkrndr::vulkan_render_target
     {
     public: // Construction
-        screen(chip8* device);
+        screen(chip8 const* device,
+            std::optional<std::filesystem::path> shader_directory);
 
         screen(screen const&) = delete;
 
@@ -38,6 +41,8 @@ namespace vkchip8
         void attach_renderer_impl(VkFormat image_format,
             uint32_t frames_in_flight) override;
 
+        void update_impl(uint32_t frame_index) const override;
+
         void render_impl(VkCommandBuffer command_buffer,
             VkExtent2D extent,
             uint32_t frame_index) const override;
@@ -52,24 +57,25 @@ namespace vkchip8
     private: // Types
         struct [[nodiscard]] frame_data final
         {
-            VkBuffer instance_buffer_{};
-            VkDeviceMemory instance_memory_{};
-            VkBuffer vertex_uniform_buffer_{};
-            VkDeviceMemory vertex_uniform_memory_{};
-            VkBuffer fragment_uniform_buffer_{};
-            VkDeviceMemory fragment_uniform_memory_{};
-            VkDescriptorSet descriptor_set_{};
+            vkrndr::vulkan_buffer instance_buffer_;
+            glm::fvec2* instance_map_{};
+            // One draw per row, drawing the instances of that row
+            vkrndr::vulkan_buffer indirect_buffer_;
+            VkDrawIndexedIndirectCommand* indirect_map_{};
+            // Row contents currently written to the instance buffer, each
+            // row owns screen_width instance slots
+            mutable std::array<uint64_t, chip8::screen_height> rows_{};
         };
 
     private: // Data
-        chip8* device_{};
+        chip8 const* device_{};
+        std::optional<std::filesystem::path> shader_directory_;
 
         std::vector<glm::fvec2> vertices_;
         std::vector<uint16_t> indices_;
-        VkDescriptorSetLayout descriptor_set_layout_{};
+        std::array<float, chip8::screen_width> column_offsets_{};
         std::unique_ptr<vkrndr::vulkan_pipeline> pipeline_;
-        VkBuffer vert_index_buffer_{};
-        VkDeviceMemory vert_index_memory_{};
+        vkrndr::vulkan_buffer vert_index_buffer_;
         std::vector<frame_data> frame_data_;
     };
 } // namespace vkchip8
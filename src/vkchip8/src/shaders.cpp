@@ -0,0 +1,20 @@
+#include <shaders.hpp>
+
+#include <vulkan_pipeline.hpp>
+
+void vkchip8::add_shader(vkrndr::vulkan_pipeline_builder& builder,
+    VkShaderStageFlagBits const stage,
+    embedded_shader const& shader,
+    std::optional<std::filesystem::path> const& override_directory)
+{
+    if (override_directory)
+    {
+        builder.add_shader(stage,
+            *override_directory / shader.file_name,
+            "main");
+    }
+    else
+    {
+        builder.add_shader(stage, shader.code, "main");
+    }
+}
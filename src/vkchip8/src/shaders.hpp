@@ -0,0 +1,68 @@
+#ifndef VKCHIP8_SHADERS_INCLUDED
+#define VKCHIP8_SHADERS_INCLUDED
+
+#include <vulkan/vulkan_core.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace vkrndr
+{
+    class vulkan_pipeline_builder;
+} // namespace vkrndr
+
+namespace vkchip8
+{
+    // SPIR-V compiled at build time, file_name is the name of the same code
+    // compiled to a file in the build directory
+    struct [[nodiscard]] embedded_shader final
+    {
+        std::string_view file_name;
+        std::span<uint32_t const> code;
+    };
+
+    namespace detail
+    {
+        inline constexpr auto screen_vertex_code{std::to_array<uint32_t>({
+#include <vert.spv.inc>
+        })};
+
+        inline constexpr auto screen_fragment_code{std::to_array<uint32_t>({
+#include <frag.spv.inc>
+        })};
+
+        inline constexpr auto bitmap_vertex_code{std::to_array<uint32_t>({
+#include <bitmap_vert.spv.inc>
+        })};
+
+        inline constexpr auto bitmap_fragment_code{std::to_array<uint32_t>({
+#include <bitmap_frag.spv.inc>
+        })};
+    } // namespace detail
+
+    inline constexpr embedded_shader screen_vertex_shader{"vert.spv",
+        detail::screen_vertex_code};
+
+    inline constexpr embedded_shader screen_fragment_shader{"frag.spv",
+        detail::screen_fragment_code};
+
+    inline constexpr embedded_shader bitmap_vertex_shader{"bitmap_vert.spv",
+        detail::bitmap_vertex_code};
+
+    inline constexpr embedded_shader bitmap_fragment_shader{
+        "bitmap_frag.spv",
+        detail::bitmap_fragment_code};
+
+    // Loads the shader from override_directory instead of using the embedded
+    // code when a directory is given, meant for iterating on shaders
+    void add_shader(vkrndr::vulkan_pipeline_builder& builder,
+        VkShaderStageFlagBits stage,
+        embedded_shader const& shader,
+        std::optional<std::filesystem::path> const& override_directory);
+} // namespace vkchip8
+
+#endif // !VKCHIP8_SHADERS_INCLUDED
@@ -0,0 +1,148 @@
+#include <shared_export.hpp>
+
+#include <fmt/format.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <utility>
+
+namespace
+{
+    static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+            std::atomic<uint32_t>::is_always_lock_free,
+        "shared atomics have to be address free");
+
+    constexpr int read_attempts{16};
+} // namespace
+
+std::optional<vkchip8::exported_frame> vkchip8::read_latest_frame(
+    shared_segment const& segment)
+{
+    for (int i{}; i != read_attempts; ++i)
+    {
+        auto const published{segment.published.load(std::memory_order_acquire)};
+        if (published == 0)
+        {
+            return std::nullopt;
+        }
+
+        auto const& slot{
+            segment.slots[(published - 1) % shared_segment::frame_slots]};
+        auto const before{slot.sequence.load(std::memory_order_acquire)};
+        if (before % 2 != 0)
+        {
+            continue;
+        }
+
+        exported_frame rv;
+        std::memcpy(&rv, &slot.frame, sizeof(rv));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before)
+        {
+            return rv;
+        }
+    }
+    return std::nullopt;
+}
+
+vkchip8::shared_export::shared_export(std::string name)
+    : name_{std::move(name)}
+{
+    if (!name_.starts_with('/'))
+    {
+        name_.insert(0, 1, '/');
+    }
+
+    int const descriptor{shm_open(name_.c_str(), O_CREAT | O_RDWR, 0600)};
+    if (descriptor == -1)
+    {
+        throw std::system_error{errno,
+            std::generic_category(),
+            fmt::format("failed to open {}", name_)};
+    }
+
+    void* const memory{ftruncate(descriptor, sizeof(shared_segment)) == 0
+            ? mmap(nullptr,
+                  sizeof(shared_segment),
+                  PROT_READ | PROT_WRITE,
+                  MAP_SHARED,
+                  descriptor,
+                  0)
+            : MAP_FAILED};
+    int const error{errno};
+    close(descriptor);
+
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink(name_.c_str());
+        throw std::system_error{error,
+            std::generic_category(),
+            fmt::format("failed to map {}", name_)};
+    }
+
+    segment_ = new (memory) shared_segment{};
+    segment_->magic = shared_segment::expected_magic;
+    segment_->version = shared_segment::expected_version;
+}
+
+vkchip8::shared_export::~shared_export()
+{
+    std::destroy_at(segment_);
+    munmap(segment_, sizeof(shared_segment));
+    shm_unlink(name_.c_str());
+}
+
+void vkchip8::shared_export::publish(chip8 const& emulator)
+{
+    auto const& state{emulator.current_state()};
+    auto& slot{segment_->slots[state.frame % shared_segment::frame_slots]};
+
+    auto const sequence{slot.sequence.load(std::memory_order_relaxed)};
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    exported_frame& frame{slot.frame};
+    frame.frame = state.frame;
+    for (size_t y{}; y != state.screen.size(); ++y)
+    {
+        frame.rows[y] = state.screen[y].to_ullong();
+    }
+    frame.data_registers = state.data_registers;
+    frame.program_counter = state.program_counter;
+    frame.i_register = state.i_register;
+    frame.delay_timer = state.delay_timer;
+    frame.sound_timer = state.sound_timer;
+    frame.keys = static_cast<uint16_t>(state.keys.to_ulong());
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    segment_->published.store(state.frame + 1, std::memory_order_release);
+}
+
+std::optional<vkchip8::shared_export::key_event>
+vkchip8::shared_export::pop_input()
+{
+    auto tail{segment_->input_tail.load(std::memory_order_relaxed)};
+    auto const head{segment_->input_head.load(std::memory_order_acquire)};
+    for (; tail != head; ++tail)
+    {
+        exported_input const input{
+            segment_->input[tail % shared_segment::input_capacity]};
+        if (input.type <= static_cast<uint8_t>(key_event_type::pressed) &&
+            input.code <= static_cast<uint8_t>(key_code::kF))
+        {
+            segment_->input_tail.store(tail + 1, std::memory_order_release);
+            return key_event{.type = static_cast<key_event_type>(input.type),
+                .code = static_cast<key_code>(input.code)};
+        }
+    }
+
+    segment_->input_tail.store(tail, std::memory_order_release);
+    return std::nullopt;
+}
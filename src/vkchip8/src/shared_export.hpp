@@ -0,0 +1,114 @@
+#ifndef VKCHIP8_SHARED_EXPORT_INCLUDED
+#define VKCHIP8_SHARED_EXPORT_INCLUDED
+
+#include <chip8.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace vkchip8
+{
+    // Machine state published after each emulated frame. Row y holds
+    // column x in bit x.
+    struct [[nodiscard]] exported_frame final
+    {
+        uint64_t frame{};
+        std::array<uint64_t, chip8::screen_height> rows{};
+        std::array<uint8_t, 16> data_registers{};
+        uint16_t program_counter{};
+        uint16_t i_register{};
+        uint8_t delay_timer{};
+        uint8_t sound_timer{};
+        uint16_t keys{};
+    };
+
+    // Key event written by a consumer, type and code use the values of
+    // key_event_type and key_code
+    struct [[nodiscard]] exported_input final
+    {
+        uint8_t type{};
+        uint8_t code{};
+    };
+
+    // Layout of the shared memory segment, native endian. Frames are written
+    // to slot frame % frame_slots guarded by a seqlock: the sequence is odd
+    // while the slot is written, readers copy the slot and retry when the
+    // sequence was odd or changed meanwhile. Input is a single producer,
+    // single consumer ring, a consumer writes the event at input_head and
+    // then increments it, keeping at most input_capacity events unread.
+    // vkchip8 reads the events at input_tail.
+    struct [[nodiscard]] shared_segment final
+    {
+        static constexpr uint32_t expected_magic{0x38434B56}; // VKC8
+        static constexpr uint32_t expected_version{1};
+        static constexpr size_t frame_slots{4};
+        static constexpr uint32_t input_capacity{64};
+
+        struct [[nodiscard]] slot final
+        {
+            std::atomic<uint64_t> sequence;
+            exported_frame frame;
+        };
+
+        uint32_t magic{};
+        uint32_t version{};
+        // Frame number of the newest complete slot plus one, zero before the
+        // first frame
+        std::atomic<uint64_t> published;
+        std::array<slot, frame_slots> slots;
+
+        alignas(64) std::atomic<uint32_t> input_head;
+        alignas(64) std::atomic<uint32_t> input_tail;
+        std::array<exported_input, input_capacity> input;
+    };
+
+    // Reads the newest frame from a mapped segment, returns nothing if no
+    // frame was published yet or the writer kept overwriting the slot
+    [[nodiscard]] std::optional<exported_frame> read_latest_frame(
+        shared_segment const& segment);
+
+    // Publishes emulator state into a POSIX shared memory object and
+    // receives input through it. Only vkchip8 writes frames, consumers never
+    // block it.
+    class [[nodiscard]] shared_export final
+    {
+    public: // Construction
+        explicit shared_export(std::string name);
+
+        shared_export(shared_export const&) = delete;
+
+        shared_export(shared_export&&) noexcept = delete;
+
+    public: // Destruction
+        // Unlinks the shared memory object
+        ~shared_export();
+
+    public: // Types
+        struct [[nodiscard]] key_event final
+        {
+            key_event_type type{};
+            key_code code{};
+        };
+
+    public: // Interface
+        void publish(chip8 const& emulator);
+
+        // Skips events with values out of range
+        [[nodiscard]] std::optional<key_event> pop_input();
+
+    public: // Operators
+        shared_export& operator=(shared_export const&) = delete;
+
+        shared_export& operator=(shared_export&&) noexcept = delete;
+
+    private: // Data
+        std::string name_;
+        shared_segment* segment_{};
+    };
+} // namespace vkchip8
+
+#endif // !VKCHIP8_SHARED_EXPORT_INCLUDED
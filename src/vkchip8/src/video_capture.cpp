@@ -0,0 +1,178 @@
+#include <video_capture.hpp>
+
+#include <cpu_profiler.hpp>
+
+#include <fmt/format.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    constexpr std::string_view frame_header{"FRAME\n"};
+
+    // Video range luma, players assume it for Y4M without a color range tag
+    constexpr char lit_luma{static_cast<char>(235)};
+    constexpr char unlit_luma{16};
+    constexpr char neutral_chroma{static_cast<char>(128)};
+} // namespace
+
+vkchip8::video_capture::video_capture(std::filesystem::path const& file,
+    uint32_t const frames_per_second,
+    uint32_t const scale,
+    size_t const capacity)
+    : stream_{file, std::ios::binary | std::ios::trunc}
+    , scale_{scale}
+    , slots_(capacity)
+{
+    if (!stream_)
+    {
+        throw std::runtime_error{
+            fmt::format("failed to open {}", file.string())};
+    }
+
+    if (scale_ == 0 || capacity == 0)
+    {
+        throw std::runtime_error{"invalid video capture parameters"};
+    }
+
+    size_t const width{chip8::screen_width * scale_};
+    size_t const height{chip8::screen_height * scale_};
+
+    std::string const header{
+        fmt::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg\n",
+            width,
+            height,
+            frames_per_second)};
+    stream_.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+    // Chroma never changes, only the luma plane is rewritten per frame
+    frame_.resize(frame_header.size() + width * height + width * height / 2,
+        neutral_chroma);
+    std::ranges::copy(frame_header, frame_.begin());
+
+    free_slots_.reserve(capacity);
+    for (size_t i{}; i != capacity; ++i)
+    {
+        free_slots_.push_back(capacity - i - 1);
+    }
+
+    writer_ = std::thread{&video_capture::write_frames, this};
+}
+
+vkchip8::video_capture::~video_capture() { finish(); }
+
+void vkchip8::video_capture::push(chip8::screen_rows const& screen)
+{
+    {
+        std::lock_guard const lock{mutex_};
+        if (stopping_ || free_slots_.empty())
+        {
+            dropped_frames_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        size_t const slot{free_slots_.back()};
+        free_slots_.pop_back();
+        slots_[slot] = screen;
+        queued_slots_.push_back(slot);
+    }
+    queued_.notify_one();
+}
+
+void vkchip8::video_capture::finish()
+{
+    {
+        std::lock_guard const lock{mutex_};
+        stopping_ = true;
+    }
+    queued_.notify_one();
+
+    if (writer_.joinable())
+    {
+        writer_.join();
+    }
+}
+
+uint64_t vkchip8::video_capture::written_frames() const noexcept
+{
+    return written_frames_.load(std::memory_order_relaxed);
+}
+
+uint64_t vkchip8::video_capture::dropped_frames() const noexcept
+{
+    return dropped_frames_.load(std::memory_order_relaxed);
+}
+
+void vkchip8::video_capture::write_frames()
+{
+    bool failed{};
+    while (true)
+    {
+        size_t slot{};
+        {
+            std::unique_lock lock{mutex_};
+            queued_.wait(lock,
+                [this]() { return stopping_ || !queued_slots_.empty(); });
+            if (queued_slots_.empty())
+            {
+                break;
+            }
+            slot = queued_slots_.front();
+            queued_slots_.pop_front();
+        }
+
+        // The slot isn't reused until it's returned, so it's encoded and
+        // written without holding the lock
+        if (!failed)
+        {
+            vkrndr::profile_zone const zone{"capture_write"};
+
+            encode(slots_[slot]);
+            if (stream_.write(frame_.data(),
+                    static_cast<std::streamsize>(frame_.size())))
+            {
+                written_frames_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                spdlog::error("Video capture stopped, write failed");
+                failed = true;
+            }
+        }
+
+        if (failed)
+        {
+            dropped_frames_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::lock_guard const lock{mutex_};
+        free_slots_.push_back(slot);
+    }
+
+    stream_.flush();
+}
+
+void vkchip8::video_capture::encode(chip8::screen_rows const& screen)
+{
+    size_t const width{chip8::screen_width * scale_};
+
+    auto luma{frame_.begin() + std::ssize(frame_header)};
+    for (auto const& row : screen)
+    {
+        auto const row_begin{luma};
+        for (size_t x{}; x != chip8::screen_width; ++x)
+        {
+            luma = std::fill_n(luma, scale_, row[x] ? lit_luma : unlit_luma);
+        }
+
+        for (uint32_t i{1}; i < scale_; ++i)
+        {
+            luma = std::copy_n(row_begin, width, luma);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef VKCHIP8_VIDEO_CAPTURE_INCLUDED
+#define VKCHIP8_VIDEO_CAPTURE_INCLUDED
+
+#include <chip8.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkchip8
+{
+    // Writes emulator screens to an uncompressed Y4M video on a background
+    // thread. Screens are copied into a fixed pool of slots, when every slot
+    // is still waiting for the writer the screen is dropped instead of
+    // blocking the caller.
+    class [[nodiscard]] video_capture final
+    {
+    public: // Construction
+        video_capture(std::filesystem::path const& file,
+            uint32_t frames_per_second,
+            uint32_t scale,
+            size_t capacity);
+
+        video_capture(video_capture const&) = delete;
+
+        video_capture(video_capture&&) noexcept = delete;
+
+    public: // Destruction
+        ~video_capture();
+
+    public: // Interface
+        // Never waits for the writer
+        void push(chip8::screen_rows const& screen);
+
+        // Writes the queued screens and stops the writer, later screens are
+        // dropped
+        void finish();
+
+        [[nodiscard]] uint64_t written_frames() const noexcept;
+
+        [[nodiscard]] uint64_t dropped_frames() const noexcept;
+
+    public: // Operators
+        video_capture& operator=(video_capture const&) = delete;
+
+        video_capture& operator=(video_capture&&) noexcept = delete;
+
+    private: // Helpers
+        void write_frames();
+
+        void encode(chip8::screen_rows const& screen);
+
+    private: // Data
+        std::ofstream stream_;
+        uint32_t scale_;
+
+        std::vector<chip8::screen_rows> slots_;
+        std::vector<size_t> free_slots_;
+        std::deque<size_t> queued_slots_;
+        std::mutex mutex_;
+        std::condition_variable queued_;
+        bool stopping_{};
+
+        std::atomic<uint64_t> written_frames_;
+        std::atomic<uint64_t> dropped_frames_;
+
+        // Only touched by the writer thread
+        std::vector<char> frame_;
+
+        std::thread writer_;
+    };
+} // namespace vkchip8
+
+#endif // !VKCHIP8_VIDEO_CAPTURE_INCLUDED
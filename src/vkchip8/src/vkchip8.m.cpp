@@ -1,24 +1,52 @@
+#include <bitmap_screen.hpp>
+#include <cpu_profiler.hpp>
 #include <global_data.hpp>
 #include <screen.hpp>
 #include <sdl_window.hpp>
 #include <vulkan_context.hpp>
 #include <vulkan_device.hpp>
+#include <vulkan_gpu_profiler.hpp>
+#include <vulkan_memory.hpp>
+#include <vulkan_offscreen_renderer.hpp>
 #include <vulkan_renderer.hpp>
 #include <vulkan_swap_chain.hpp>
 
 #include <chip8.hpp>
+#include <frame_scheduler.hpp>
+#include <input_movie.hpp>
+#include <options.hpp>
 #include <pc_speaker.hpp>
+#include <profiler_window.hpp>
+#include <random_engine.hpp>
+#include <rewind_buffer.hpp>
+#include <screen_delta.hpp>
+#ifdef VKCHIP8_SHARED_EXPORT
+#include <shared_export.hpp>
+#endif
+#include <video_capture.hpp>
 
 #include <SDL.h>
 #include <imgui.h>
 #include <imgui_impl_sdl2.h>
 #include <imgui_impl_vulkan.h>
 
+#include <fmt/format.h>
+
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace
@@ -41,6 +69,21 @@ namespace
 
         return buffer;
     }
+
+    // Pipelines are cached in the per user data directory between runs
+    [[nodiscard]] std::optional<std::filesystem::path>
+    pipeline_cache_directory()
+    {
+        char* const directory{SDL_GetPrefPath("", "vkchip8")};
+        if (!directory)
+        {
+            return std::nullopt;
+        }
+
+        std::filesystem::path rv{directory};
+        SDL_free(directory);
+        return rv;
+    }
 } // namespace
 
 namespace
@@ -51,6 +94,17 @@ namespace
     constexpr bool enable_validation_layers{true};
 #endif
 
+    constexpr uint32_t cycles_per_frame{16};
+
+    constexpr uint32_t frames_per_second{60};
+
+    // Captured video is 256x128, two seconds of frames may wait for the disk
+    constexpr uint32_t capture_scale{4};
+    constexpr size_t capture_queue_frames{2 * frames_per_second};
+
+    // Snapshots are mostly small deltas, keyframes take ~4.4KB each
+    constexpr size_t rewind_bytes_per_second{32 * 1024};
+
     std::map<SDL_Keycode, vkchip8::key_code> key_map{
         {SDLK_1, vkchip8::key_code::k1},
         {SDLK_2, vkchip8::key_code::k2},
@@ -69,11 +123,405 @@ namespace
         {SDLK_c, vkchip8::key_code::kB},
         {SDLK_v, vkchip8::key_code::kF},
     };
+
+    [[nodiscard]] vkchip8::input_movie load_movie(
+        std::filesystem::path const& file)
+    {
+        std::ifstream stream{file, std::ios::binary};
+        if (!stream.is_open())
+        {
+            throw std::runtime_error{"failed to open file!"};
+        }
+
+        return vkchip8::input_movie::load(stream);
+    }
+
+    void save_movie(vkchip8::input_movie const& movie,
+        std::filesystem::path const& file)
+    {
+        std::ofstream stream{file, std::ios::binary | std::ios::trunc};
+        if (!stream.is_open())
+        {
+            throw std::runtime_error{"failed to open file!"};
+        }
+
+        movie.save(stream);
+    }
+
+    // Time from a key event to a point in the life of the frame which first
+    // reflects it, in milliseconds
+    struct [[nodiscard]] latency_history final
+    {
+        std::array<float, 120> values{};
+        size_t next{};
+        size_t count{};
+
+        void add(uint32_t const milliseconds)
+        {
+            values[next] = static_cast<float>(milliseconds);
+            next = (next + 1) % values.size();
+            count = std::min(count + 1, values.size());
+        }
+    };
+
+    // Key event waiting for the GPU to finish the frame which reflects it
+    struct [[nodiscard]] pending_input final
+    {
+        uint32_t timestamp{};
+        uint64_t frame{};
+    };
+
+    // Completion is noticed when polled, so the latency is an upper bound
+    // which is off by at most the time between two polls
+    void complete_inputs(std::deque<pending_input>& pending,
+        uint64_t const completed_frame,
+        latency_history& latency)
+    {
+        while (!pending.empty() && pending.front().frame <= completed_frame)
+        {
+            latency.add(SDL_GetTicks() - pending.front().timestamp);
+            pending.pop_front();
+        }
+    }
+
+    void plot_latency(char const* const label,
+        char const* const id,
+        latency_history const& latency)
+    {
+        if (latency.count != 0)
+        {
+            auto const last{
+                (latency.next + latency.values.size() - 1) %
+                latency.values.size()};
+            ImGui::Text("%s: %.0f ms",
+                label,
+                static_cast<double>(latency.values[last]));
+        }
+        ImGui::PlotLines(id,
+            latency.values.data(),
+            static_cast<int>(latency.count),
+            latency.count == latency.values.size()
+                ? static_cast<int>(latency.next)
+                : 0,
+            nullptr,
+            0.f,
+            50.f,
+            ImVec2{0, 80});
+    }
+
+    void show_latency(latency_history const& submit_latency,
+        latency_history const& completion_latency,
+        vkchip8::frame_scheduler const& scheduler)
+    {
+        ImGui::Begin("Latency");
+        plot_latency("Input to submit", "##submit_latency", submit_latency);
+        plot_latency("Input to GPU completion",
+            "##completion_latency",
+            completion_latency);
+        ImGui::Text("Frame work estimate: %.2f ms",
+            static_cast<double>(scheduler.work_estimate()) * 1000.0 /
+                static_cast<double>(SDL_GetPerformanceFrequency()));
+        ImGui::End();
+    }
+
+    // GPU time of measured frames in milliseconds
+    struct [[nodiscard]] gpu_time_history final
+    {
+        std::array<float, 120> values{};
+        size_t next{};
+        size_t count{};
+        uint64_t last_frame{};
+
+        void add(vkrndr::gpu_frame_timings const& timings)
+        {
+            if (timings.frame == last_frame)
+            {
+                return;
+            }
+
+            last_frame = timings.frame;
+            values[next] = static_cast<float>(timings.frame_ms);
+            next = (next + 1) % values.size();
+            count = std::min(count + 1, values.size());
+        }
+    };
+
+    void show_statistics(char const* const label,
+        vkrndr::gpu_pipeline_statistics const& statistics)
+    {
+        ImGui::Text("%s: %llu vertices, %llu primitives, %llu fragments",
+            label,
+            static_cast<unsigned long long>(statistics.input_vertices),
+            static_cast<unsigned long long>(statistics.clipping_primitives),
+            static_cast<unsigned long long>(statistics.fragment_invocations));
+    }
+
+    void show_gpu_timings(vkrndr::vulkan_gpu_profiler const& profiler,
+        gpu_time_history& history)
+    {
+        ImGui::Begin("GPU time");
+        auto const& timings{profiler.latest()};
+        if (!timings)
+        {
+            ImGui::TextUnformatted(profiler.enabled()
+                    ? "Waiting for results"
+                    : "Timestamps are not supported");
+            ImGui::End();
+            return;
+        }
+
+        history.add(*timings);
+        ImGui::Text("Frame: %.3f ms", timings->frame_ms);
+        ImGui::PlotLines("##gpu_time",
+            history.values.data(),
+            static_cast<int>(history.count),
+            history.count == history.values.size()
+                ? static_cast<int>(history.next)
+                : 0,
+            nullptr,
+            0.f,
+            4.f,
+            ImVec2{0, 80});
+        for (size_t i{}; i != timings->target_ms.size(); ++i)
+        {
+            ImGui::Text("Target %zu: %.3f ms", i, timings->target_ms[i]);
+        }
+        ImGui::Text("UI: %.3f ms", timings->imgui_ms);
+        ImGui::Text("Resolve: %.3f ms", timings->resolve_ms);
+        if (timings->target_statistics)
+        {
+            show_statistics("Targets", *timings->target_statistics);
+        }
+        if (timings->imgui_statistics)
+        {
+            show_statistics("UI", *timings->imgui_statistics);
+        }
+        ImGui::End();
+    }
+
+    [[nodiscard]] std::ofstream open_output(
+        std::filesystem::path const& file)
+    {
+        std::ofstream rv{file, std::ios::binary | std::ios::trunc};
+        if (!rv)
+        {
+            throw std::runtime_error{
+                fmt::format("failed to open {}", file.string())};
+        }
+        return rv;
+    }
+
+    void show_memory_statistics(vkrndr::vulkan_device const& device)
+    {
+        constexpr double mebibyte{1024.0 * 1024.0};
+
+        auto const statistics{device.allocator()->statistics()};
+        ImGui::Begin("GPU memory");
+        ImGui::Text("Blocks: %u", statistics.block_count);
+        ImGui::Text("Allocations: %u", statistics.allocation_count);
+        ImGui::Text("Used: %.2f / %.2f MiB",
+            static_cast<double>(statistics.used_bytes) / mebibyte,
+            static_cast<double>(statistics.reserved_bytes) / mebibyte);
+        ImGui::End();
+    }
+
+    [[nodiscard]] vkrndr::swap_chain_settings swap_chain_settings(
+        vkchip8::options const& options)
+    {
+        vkrndr::swap_chain_settings rv;
+        rv.frames_in_flight = options.frames_in_flight;
+        rv.image_count = options.image_count;
+        switch (options.presentation)
+        {
+        case vkchip8::present_mode::fifo:
+            rv.present_mode = VK_PRESENT_MODE_FIFO_KHR;
+            break;
+        case vkchip8::present_mode::fifo_relaxed:
+            rv.present_mode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+            break;
+        case vkchip8::present_mode::mailbox:
+            rv.present_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+            break;
+        case vkchip8::present_mode::immediate:
+            rv.present_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+            break;
+        }
+        return rv;
+    }
+
+    void run_frame(vkchip8::chip8& emulator)
+    {
+        for (uint32_t i{}; i != cycles_per_frame; ++i)
+        {
+            emulator.tick();
+        }
+
+        emulator.tick_timers();
+    }
+
+    [[nodiscard]] std::unique_ptr<vkrndr::vulkan_render_target> create_screen(
+        vkchip8::options const& options,
+        vkchip8::chip8 const* const emulator)
+    {
+        if (options.renderer == vkchip8::screen_renderer::bitmap)
+        {
+            return std::make_unique<vkchip8::bitmap_screen>(emulator,
+                options.shader_directory);
+        }
+        return std::make_unique<vkchip8::screen>(emulator,
+            options.shader_directory);
+    }
+
+    // Runs a copy of the emulator ahead with the current input so the
+    // presented frame already reflects input received during this frame
+    void run_ahead(vkchip8::chip8 const& emulator,
+        vkchip8::chip8& ahead,
+        uint32_t const frames)
+    {
+        ahead.restore_state(emulator.current_state());
+        for (uint32_t i{}; i != frames; ++i)
+        {
+            run_frame(ahead);
+        }
+    }
+
+    // Binary PPM, the alpha channel is dropped
+    void write_ppm(std::filesystem::path const& file,
+        vkrndr::offscreen_frame const& frame)
+    {
+        std::ofstream stream{file, std::ios::binary | std::ios::trunc};
+
+        std::string const header{fmt::format("P6\n{} {}\n255\n",
+            frame.extent.width,
+            frame.extent.height)};
+        stream.write(header.data(),
+            static_cast<std::streamsize>(header.size()));
+        for (size_t i{}; i < frame.pixels.size(); i += 4)
+        {
+            // NOLINTNEXTLINE
+            stream.write(reinterpret_cast<char const*>(&frame.pixels[i]), 3);
+        }
+
+        if (!stream.flush())
+        {
+            throw std::runtime_error{"failed to write thumbnail"};
+        }
+    }
+
+    // Renders the screen without a window through the same pipelines used
+    // when running interactively
+    void write_thumbnail(vkchip8::options const& options,
+        vkchip8::chip8 const& emulator)
+    {
+        constexpr VkExtent2D extent{640, 320};
+
+        auto context{vkrndr::create_context(nullptr, enable_validation_layers)};
+        auto device{vkrndr::create_device(context, pipeline_cache_directory())};
+        vkrndr::vulkan_offscreen_renderer renderer{&device, extent, 1};
+
+        auto const screen_renderer{create_screen(options, &emulator)};
+        screen_renderer->attach_renderer(&device,
+            renderer.descriptor_pool(),
+            renderer.uploader(),
+            renderer.deletion_queue(),
+            renderer.image_format(),
+            renderer.frames_in_flight());
+
+        std::array<vkrndr::vulkan_render_target const*, 1> targets{
+            screen_renderer.get()};
+        write_ppm(*options.thumbnail, renderer.read(renderer.draw(targets)));
+    }
+
+    int run_headless(vkchip8::options const& options)
+    {
+        auto const movie{load_movie(*options.replay_movie)};
+
+        vkchip8::chip8 emulator;
+        vkchip8::movie_player player{&movie, &emulator};
+        if (options.seek_frame)
+        {
+            player.seek(*options.seek_frame);
+        }
+
+        std::ofstream delta_stream;
+        std::optional<vkchip8::screen_delta_writer> deltas;
+        if (options.screen_deltas)
+        {
+            delta_stream = open_output(*options.screen_deltas);
+            deltas.emplace(&delta_stream);
+        }
+
+        auto const start_frame{emulator.current_state().frame};
+        auto const start{std::chrono::steady_clock::now()};
+        while (!player.finished())
+        {
+            player.run_frame();
+            if (deltas)
+            {
+                deltas->write(emulator.screen_data());
+            }
+        }
+        std::chrono::duration<double, std::milli> const elapsed{
+            std::chrono::steady_clock::now() - start};
+
+        spdlog::info("Replayed frames {} to {} in {:.3f} ms",
+            start_frame,
+            emulator.current_state().frame,
+            elapsed.count());
+
+        if (deltas)
+        {
+            deltas->flush();
+        }
+
+        if (options.thumbnail)
+        {
+            write_thumbnail(options, emulator);
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    // Usage errors are logged instead of escaping main
+    [[nodiscard]] std::optional<vkchip8::options> parse_command_line(
+        int const argc,
+        char const* const* const argv)
+    {
+        try
+        {
+            auto rv{vkchip8::parse_options(argc, argv)};
+#ifndef VKCHIP8_SHARED_EXPORT
+            if (rv.shared_export)
+            {
+                throw std::runtime_error{
+                    "shared memory export isn't supported on this platform"};
+            }
+#endif
+            return rv;
+        }
+        catch (std::runtime_error const& e)
+        {
+            spdlog::error("Invalid command line: {}", e.what());
+            return std::nullopt;
+        }
+    }
 } // namespace
 
 // Main code
-int main([[maybe_unused]] int argc, char** argv)
+int main(int argc, char** argv)
 {
+    auto const parsed_options{parse_command_line(argc, argv)};
+    if (!parsed_options)
+    {
+        return EXIT_FAILURE;
+    }
+
+    auto const& options{*parsed_options};
+    if (options.headless)
+    {
+        return run_headless(options);
+    }
+
     vkrndr::sdl_guard sdl_guard{SDL_INIT_VIDEO | SDL_INIT_AUDIO};
 
     vkrndr::sdl_window window{"vkchip8",
@@ -85,66 +533,252 @@ int main([[maybe_unused]] int argc, char** argv)
 
     vkchip8::pc_speaker speaker;
 
-    auto code{read_file(argv[1])};
+    uint64_t const seed{std::random_device{}()};
     vkchip8::chip8 emulator{vkchip8::chip8::memory_size,
-        std::random_device{}(),
+        vkchip8::random_engine{seed},
         [&speaker]() { speaker.beep(); }};
 
-    emulator.load(vkrndr::as_bytes(code));
+    std::optional<vkchip8::input_movie> movie;
+    std::optional<vkchip8::movie_player> player;
+    if (options.replay_movie)
+    {
+        movie = load_movie(*options.replay_movie);
+        player.emplace(&*movie, &emulator);
+        if (options.seek_frame)
+        {
+            player->seek(*options.seek_frame);
+        }
+    }
+    else
+    {
+        auto code{read_file(options.rom)};
+        emulator.load(vkrndr::as_bytes(code));
+
+        if (options.record_movie)
+        {
+            movie.emplace(emulator,
+                seed,
+                cycles_per_frame,
+                options.keyframe_interval);
+        }
+    }
 
     {
         auto context{vkrndr::create_context(&window, enable_validation_layers)};
-        auto device{vkrndr::create_device(context)};
-        vkrndr::vulkan_swap_chain swap_chain{&window, &context, &device};
+        auto device{vkrndr::create_device(context, pipeline_cache_directory())};
+        vkrndr::vulkan_swap_chain swap_chain{&window,
+            &context,
+            &device,
+            swap_chain_settings(options)};
         vkrndr::vulkan_renderer renderer{&window,
             &context,
             &device,
             &swap_chain};
 
-        vkchip8::screen screen_renderer{&emulator};
-        screen_renderer.attach_renderer(&device,
+        // Predicted frames only make sense for live input
+        uint32_t const run_ahead_frames{player ? 0 : options.run_ahead};
+        vkchip8::chip8 ahead;
+        auto const screen_renderer{create_screen(options,
+            run_ahead_frames != 0 ? &ahead : &emulator)};
+        screen_renderer->attach_renderer(&device,
             renderer.descriptor_pool(),
+            renderer.uploader(),
+            renderer.deletion_queue(),
             swap_chain.image_format(),
-            swap_chain.image_count());
+            renderer.frames_in_flight());
+
+        // Rewinding is disabled while a movie is recorded or replayed, as it
+        // would break the recorded timeline
+        std::optional<vkchip8::rewind_buffer> rewind;
+        if (options.rewind_seconds != 0 && !movie)
+        {
+            rewind.emplace(size_t{options.rewind_seconds} * frames_per_second,
+                size_t{options.rewind_seconds} * rewind_bytes_per_second,
+                frames_per_second);
+        }
+        vkchip8::chip8::state rewound_state;
+
+        std::ofstream delta_stream;
+        std::optional<vkchip8::screen_delta_writer> deltas;
+        if (options.screen_deltas)
+        {
+            delta_stream = open_output(*options.screen_deltas);
+            deltas.emplace(&delta_stream);
+        }
+
+        std::optional<vkchip8::video_capture> capture;
+        if (options.capture)
+        {
+            capture.emplace(*options.capture,
+                frames_per_second,
+                capture_scale,
+                capture_queue_frames);
+        }
+
+#ifdef VKCHIP8_SHARED_EXPORT
+        std::optional<vkchip8::shared_export> exported;
+        if (options.shared_export)
+        {
+            exported.emplace(*options.shared_export);
+        }
+#endif
+
+        vkchip8::frame_scheduler scheduler{frames_per_second};
+        std::optional<uint32_t> oldest_input;
+        std::deque<pending_input> pending_inputs;
+        latency_history submit_latency;
+        latency_history completion_latency;
+        gpu_time_history gpu_time;
+        vkchip8::profiler_window profiler{options.trace};
 
-        uint64_t last_tick{SDL_GetPerformanceCounter()};
         bool done = false;
         while (!done)
         {
-            SDL_Event event;
-            while (SDL_PollEvent(&event))
+            // Input is latched just before the frame is emulated
             {
-                ImGui_ImplSDL2_ProcessEvent(&event);
-                if (event.type == SDL_QUIT)
+                vkrndr::profile_zone const zone{"wait"};
+                scheduler.wait_for_frame_start();
+            }
+            scheduler.begin_frame();
+            complete_inputs(pending_inputs,
+                swap_chain.completed_frame(),
+                completion_latency);
+
+            {
+                vkrndr::profile_zone const zone{"events"};
+
+                SDL_Event event;
+                while (SDL_PollEvent(&event))
                 {
-                    done = true;
+                    ImGui_ImplSDL2_ProcessEvent(&event);
+                    if (event.type == SDL_QUIT)
+                    {
+                        done = true;
+                    }
+                    if (event.type == SDL_WINDOWEVENT &&
+                        event.window.event == SDL_WINDOWEVENT_CLOSE &&
+                        event.window.windowID ==
+                            SDL_GetWindowID(window.native_handle()))
+                    {
+                        done = true;
+                    }
+
+                    if (player)
+                    {
+                        continue;
+                    }
+
+                    if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
+                    {
+                        if (auto it{key_map.find(event.key.keysym.sym)};
+                            it != key_map.cend())
+                        {
+                            auto const type{event.type == SDL_KEYDOWN
+                                    ? vkchip8::key_event_type::pressed
+                                    : vkchip8::key_event_type::released};
+                            emulator.key_event(type, it->second);
+                            if (!oldest_input)
+                            {
+                                oldest_input = event.key.timestamp;
+                            }
+                            if (movie)
+                            {
+                                movie->record_event(emulator, type, it->second);
+                            }
+                        }
+                        else if (event.key.keysym.sym != SDLK_BACKSPACE)
+                        {
+                            spdlog::error("Unrecogrnized key code: {}",
+                                event.key.keysym.sym);
+                        }
+                    }
                 }
-                if (event.type == SDL_WINDOWEVENT &&
-                    event.window.event == SDL_WINDOWEVENT_CLOSE &&
-                    event.window.windowID ==
-                        SDL_GetWindowID(window.native_handle()))
+
+#ifdef VKCHIP8_SHARED_EXPORT
+                // External input is treated like the keyboard
+                while (auto const input{
+                           exported ? exported->pop_input() : std::nullopt})
                 {
-                    done = true;
+                    if (player)
+                    {
+                        continue;
+                    }
+
+                    emulator.key_event(input->type, input->code);
+                    if (movie)
+                    {
+                        movie->record_event(emulator, input->type, input->code);
+                    }
                 }
+#endif
+            }
+
+            {
+                vkrndr::profile_zone const zone{"emulation"};
 
-                if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
+                bool const rewinding{rewind &&
+                    SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_BACKSPACE] != 0};
+                if (rewinding)
+                {
+                    if (rewind->pop(rewound_state))
+                    {
+                        emulator.restore_state(rewound_state);
+                    }
+                }
+                else if (!player)
                 {
-                    if (auto it{key_map.find(event.key.keysym.sym)};
-                        it != key_map.cend())
+                    run_frame(emulator);
+                    if (rewind)
                     {
-                        emulator.key_event(event.type == SDL_KEYDOWN
-                                ? vkchip8::key_event_type::pressed
-                                : vkchip8::key_event_type::released,
-                            it->second);
+                        rewind->push(emulator.current_state());
                     }
-                    else
+                    if (movie)
                     {
-                        spdlog::error("Unrecogrnized key code: {}",
-                            event.key.keysym.sym);
+                        movie->record_frame(emulator);
                     }
                 }
+                else if (!player->finished())
+                {
+                    player->run_frame();
+                }
+                speaker.tick();
+
+                if (deltas)
+                {
+                    deltas->write(emulator.screen_data());
+                }
+
+#ifdef VKCHIP8_SHARED_EXPORT
+                if (exported)
+                {
+                    exported->publish(emulator);
+                }
+#endif
+
+                if (run_ahead_frames != 0)
+                {
+                    run_ahead(emulator,
+                        ahead,
+                        rewinding ? 0 : run_ahead_frames);
+                }
             }
 
+            {
+                vkrndr::profile_zone const zone{"imgui_new_frame"};
+
+                ImGui_ImplVulkan_NewFrame();
+                ImGui_ImplSDL2_NewFrame();
+                ImGui::NewFrame();
+            }
+
+            profiler.draw(vkrndr::global_cpu_profiler());
+            show_latency(submit_latency, completion_latency, scheduler);
+            show_memory_statistics(device);
+            show_gpu_timings(*renderer.gpu_profiler(), gpu_time);
+
+            // Waiting for the swap chain and the GPU isn't part of the work
+            scheduler.end_frame();
+
             if (vkrndr::swap_chain_refresh.load())
             {
                 while (SDL_GetWindowFlags(window.native_handle()) &
@@ -153,42 +787,62 @@ int main([[maybe_unused]] int argc, char** argv)
                     SDL_WaitEvent(nullptr);
                 }
 
-                vkDeviceWaitIdle(device.logical());
+                // Resources of the old chain are released once the frames
+                // using them retire, the device keeps running
                 swap_chain.recreate();
                 renderer.recreate();
                 vkrndr::swap_chain_refresh.store(false);
             }
 
-            uint64_t const current_tick{SDL_GetPerformanceCounter()};
-            if (current_tick - last_tick <= SDL_GetPerformanceFrequency() / 60)
-            {
-                continue;
-            }
-            last_tick = current_tick;
+            std::array render_targets{
+                static_cast<vkrndr::vulkan_render_target const*>(
+                    screen_renderer.get())};
 
-            ImGui_ImplVulkan_NewFrame();
-            ImGui_ImplSDL2_NewFrame();
-            ImGui::NewFrame();
+            uint64_t const last_submitted{swap_chain.submitted_frame()};
+            renderer.draw(render_targets);
 
-            ImGui::ShowMetricsWindow();
+            if (capture)
+            {
+                capture->push(run_ahead_frames != 0 ? ahead.screen_data()
+                                                    : emulator.screen_data());
+            }
 
-            for (auto i{0}; i != 16; ++i)
+            // Skipped frames leave the input to the next submitted one
+            if (oldest_input && swap_chain.submitted_frame() != last_submitted)
             {
-                emulator.tick();
+                submit_latency.add(SDL_GetTicks() - *oldest_input);
+                pending_inputs.push_back({.timestamp = *oldest_input,
+                    .frame = swap_chain.submitted_frame()});
+                oldest_input.reset();
             }
+            complete_inputs(pending_inputs,
+                swap_chain.completed_frame(),
+                completion_latency);
 
-            emulator.tick_timers();
-            speaker.tick();
+            vkrndr::global_cpu_profiler().end_frame();
+        }
+        vkDeviceWaitIdle(device.logical());
 
-            std::array render_targets{
-                static_cast<vkrndr::vulkan_render_target const*>(
-                    &screen_renderer)};
+        screen_renderer->detach_renderer();
 
-            renderer.draw(render_targets);
+        if (deltas)
+        {
+            deltas->flush();
+            spdlog::info("Wrote {} screen deltas", deltas->frames());
         }
-        vkDeviceWaitIdle(device.logical());
 
-        screen_renderer.detach_renderer();
+        if (capture)
+        {
+            capture->finish();
+            spdlog::info("Captured {} frames, dropped {}",
+                capture->written_frames(),
+                capture->dropped_frames());
+        }
+    }
+
+    if (options.record_movie)
+    {
+        save_movie(*movie, *options.record_movie);
     }
 
     return EXIT_SUCCESS;
@@ -1,5 +1,30 @@
+#include <options.hpp>
+#ifdef VKCHIP8_SHARED_EXPORT
+#include <shared_export.hpp>
+#endif
+#include <video_capture.hpp>
+
 #include <catch2/catch_test_macros.hpp>
 
+#include <fmt/format.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef VKCHIP8_SHARED_EXPORT
+#include <sys/mman.h>
+#endif
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
 TEST_CASE("vectors can be sized and resized", "[vector]")
@@ -40,3 +65,264 @@ TEST_CASE("vectors can be sized and resized", "[vector]")
         REQUIRE(vec.capacity() >= 5);
     }
 }
+
+namespace
+{
+    [[nodiscard]] vkchip8::options parse(
+        std::initializer_list<char const*> const arguments)
+    {
+        std::vector<char const*> argv{"vkchip8"};
+        argv.insert(argv.end(), arguments);
+        return vkchip8::parse_options(static_cast<int>(argv.size()),
+            argv.data());
+    }
+} // namespace
+
+TEST_CASE("options accept valid mode combinations", "[options]")
+{
+    CHECK(parse({"rom.ch8", "--record", "a.movie"}).record_movie);
+
+    auto const headless{parse(
+        {"--replay", "a.movie", "--headless", "--thumbnail", "a.ppm"})};
+    CHECK(headless.headless);
+    CHECK(headless.replay_movie);
+    CHECK(headless.thumbnail);
+}
+
+TEST_CASE("options reject conflicting modes", "[options]")
+{
+    CHECK_THROWS_AS(
+        parse({"rom.ch8", "--record", "a.movie", "--replay", "b.movie"}),
+        std::runtime_error);
+    CHECK_THROWS_AS(parse({"rom.ch8", "--headless"}), std::runtime_error);
+    CHECK_THROWS_AS(parse({"--replay", "a.movie", "--thumbnail", "a.ppm"}),
+        std::runtime_error);
+}
+
+#ifdef VKCHIP8_SHARED_EXPORT
+namespace
+{
+    // Maps the segment of an export the way a consumer process would
+    class [[nodiscard]] consumer_mapping final
+    {
+    public: // Construction
+        explicit consumer_mapping(std::string const& name)
+        {
+            int const descriptor{shm_open(name.c_str(), O_RDWR, 0)};
+            REQUIRE(descriptor != -1);
+            void* const memory{mmap(nullptr,
+                sizeof(vkchip8::shared_segment),
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED,
+                descriptor,
+                0)};
+            close(descriptor);
+            REQUIRE(memory != MAP_FAILED);
+            segment_ = static_cast<vkchip8::shared_segment*>(memory);
+        }
+
+        consumer_mapping(consumer_mapping const&) = delete;
+
+        consumer_mapping(consumer_mapping&&) noexcept = delete;
+
+    public: // Destruction
+        ~consumer_mapping() { munmap(segment_, sizeof(*segment_)); }
+
+    public: // Interface
+        [[nodiscard]] vkchip8::shared_segment& segment() { return *segment_; }
+
+        void push_input(uint8_t const type, uint8_t const code)
+        {
+            auto const head{
+                segment_->input_head.load(std::memory_order_relaxed)};
+            segment_->input[head % vkchip8::shared_segment::input_capacity] =
+                {.type = type, .code = code};
+            segment_->input_head.store(head + 1, std::memory_order_release);
+        }
+
+    public: // Operators
+        consumer_mapping& operator=(consumer_mapping const&) = delete;
+
+        consumer_mapping& operator=(consumer_mapping&&) noexcept = delete;
+
+    private: // Data
+        vkchip8::shared_segment* segment_{};
+    };
+
+    [[nodiscard]] std::string export_name()
+    {
+        return fmt::format("/vkchip8_test_{}", getpid());
+    }
+} // namespace
+
+TEST_CASE("shared export publishes the latest frame", "[shared_export]")
+{
+    std::string const name{export_name()};
+    vkchip8::shared_export exported{name};
+    consumer_mapping consumer{name};
+
+    CHECK(consumer.segment().magic == vkchip8::shared_segment::expected_magic);
+    CHECK_FALSE(vkchip8::read_latest_frame(consumer.segment()).has_value());
+
+    vkchip8::chip8 emulator;
+    emulator.key_event(vkchip8::key_event_type::pressed, vkchip8::key_code::k3);
+    exported.publish(emulator);
+
+    auto const first{vkchip8::read_latest_frame(consumer.segment())};
+    REQUIRE(first.has_value());
+    CHECK(first->frame == 0);
+    CHECK(first->keys == 1 << 3);
+    CHECK(first->program_counter ==
+        emulator.current_state().program_counter);
+
+    // Later frames reuse the slots in a ring
+    for (size_t i{}; i != vkchip8::shared_segment::frame_slots + 1; ++i)
+    {
+        emulator.tick_timers();
+        exported.publish(emulator);
+    }
+
+    auto const wrapped{vkchip8::read_latest_frame(consumer.segment())};
+    REQUIRE(wrapped.has_value());
+    CHECK(wrapped->frame == vkchip8::shared_segment::frame_slots + 1);
+    CHECK(consumer.segment().published.load() == wrapped->frame + 1);
+    CHECK(consumer.segment().slots[1].sequence.load() == 4);
+}
+
+TEST_CASE("shared export drains input in order", "[shared_export]")
+{
+    std::string const name{export_name()};
+    vkchip8::shared_export exported{name};
+    consumer_mapping consumer{name};
+
+    CHECK_FALSE(exported.pop_input().has_value());
+
+    consumer.push_input(1, 0xA);
+    consumer.push_input(2, 0x1); // Type out of range
+    consumer.push_input(0, 0x10); // Code out of range
+    consumer.push_input(0, 0xA);
+
+    auto const pressed{exported.pop_input()};
+    REQUIRE(pressed.has_value());
+    CHECK(pressed->type == vkchip8::key_event_type::pressed);
+    CHECK(pressed->code == vkchip8::key_code::kA);
+
+    auto const released{exported.pop_input()};
+    REQUIRE(released.has_value());
+    CHECK(released->type == vkchip8::key_event_type::released);
+    CHECK(released->code == vkchip8::key_code::kA);
+
+    CHECK_FALSE(exported.pop_input().has_value());
+    CHECK(consumer.segment().input_tail.load() == 4);
+}
+#endif
+
+namespace
+{
+    [[nodiscard]] std::string video_header(size_t const scale)
+    {
+        return fmt::format("YUV4MPEG2 W{} H{} F60:1 Ip A1:1 C420jpeg\n",
+            vkchip8::chip8::screen_width * scale,
+            vkchip8::chip8::screen_height * scale);
+    }
+
+    // FRAME tag, luma plane and both quarter size chroma planes
+    [[nodiscard]] size_t video_frame_size(size_t const scale)
+    {
+        size_t const pixels{vkchip8::chip8::screen_width *
+            vkchip8::chip8::screen_height * scale * scale};
+        return 6 + pixels + pixels / 2;
+    }
+} // namespace
+
+TEST_CASE("video capture writes scaled Y4M frames", "[video_capture]")
+{
+    auto const file{std::filesystem::temp_directory_path() /
+        "vkchip8_test_capture.y4m"};
+
+    vkchip8::chip8::screen_rows screen{};
+    screen[1].set(2);
+    {
+        vkchip8::video_capture capture{file, 60, 2, 4};
+        capture.push(vkchip8::chip8::screen_rows{});
+        capture.push(screen);
+        capture.finish();
+
+        CHECK(capture.written_frames() == 2);
+        CHECK(capture.dropped_frames() == 0);
+    }
+
+    std::ifstream stream{file, std::ios::binary};
+    std::string const contents{std::istreambuf_iterator<char>{stream}, {}};
+    stream.close();
+    std::filesystem::remove(file);
+
+    std::string const header{video_header(2)};
+    REQUIRE(contents.size() == header.size() + 2 * video_frame_size(2));
+    CHECK(contents.starts_with(header));
+
+    // Pixel (2, 1) of the second frame covers luma rows 2-3, columns 4-5
+    auto const luma{[&](size_t const frame, size_t const x, size_t const y)
+        {
+            size_t const offset{header.size() +
+                frame * video_frame_size(2) + 6 +
+                y * vkchip8::chip8::screen_width * 2 + x};
+            return static_cast<unsigned char>(contents[offset]);
+        }};
+    CHECK(contents.compare(header.size(), 6, "FRAME\n") == 0);
+    CHECK(luma(0, 4, 2) == 16);
+    CHECK(luma(1, 4, 2) == 235);
+    CHECK(luma(1, 5, 3) == 235);
+    CHECK(luma(1, 6, 3) == 16);
+}
+
+#ifndef _WIN32
+TEST_CASE("video capture drops frames while its queue is full",
+    "[video_capture]")
+{
+    // A frame at this scale doesn't fit into the pipe buffer, the writer
+    // blocks on the first one until the pipe is read
+    constexpr size_t scale{8};
+    auto const fifo{std::filesystem::temp_directory_path() /
+        fmt::format("vkchip8_test_capture_{}", getpid())};
+    REQUIRE(mkfifo(fifo.c_str(), 0600) == 0);
+
+    int const reader{open(fifo.c_str(), O_RDONLY | O_NONBLOCK)};
+    REQUIRE(reader != -1);
+    fcntl(reader, F_SETFL, fcntl(reader, F_GETFL) & ~O_NONBLOCK);
+
+    size_t read_bytes{};
+    std::thread drain;
+    {
+        vkchip8::video_capture capture{fifo, 60, scale, 2};
+
+        // Without a writer the reader would see the end of the file
+        drain = std::thread{[reader, &read_bytes]()
+            {
+                std::vector<char> buffer(1 << 16);
+                ssize_t count{};
+                while ((count = read(reader, buffer.data(), buffer.size())) > 0)
+                {
+                    read_bytes += static_cast<size_t>(count);
+                }
+            }};
+
+        for (int i{}; i != 5; ++i)
+        {
+            capture.push(vkchip8::chip8::screen_rows{});
+        }
+        CHECK(capture.dropped_frames() == 3);
+
+        capture.finish();
+        CHECK(capture.written_frames() == 2);
+    }
+
+    // Closing the stream ends the file for the reader
+    drain.join();
+    close(reader);
+    std::filesystem::remove(fifo);
+
+    CHECK(read_bytes ==
+        video_header(scale).size() + 2 * video_frame_size(scale));
+}
+#endif
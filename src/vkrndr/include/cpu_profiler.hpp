@@ -0,0 +1,139 @@
+#ifndef VKRNDR_CPU_PROFILER_INCLUDED
+#define VKRNDR_CPU_PROFILER_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace vkrndr
+{
+    // Interval measured on a thread, times are nanoseconds since the
+    // profiler was created. Zones nested in others have a larger depth.
+    struct [[nodiscard]] cpu_zone final
+    {
+        char const* name{};
+        uint64_t begin{};
+        uint64_t end{};
+        uint32_t thread{};
+        uint32_t depth{};
+    };
+
+    // Zones of all threads which ended between two calls of end_frame
+    struct [[nodiscard]] cpu_frame final
+    {
+        uint64_t begin{};
+        uint64_t end{};
+        std::vector<cpu_zone> zones;
+    };
+
+    // Collects zones of any thread into a buffer owned by that thread.
+    // Recording only touches the buffer of the calling thread, a thread
+    // takes the lock once when it records its first zone. A single thread
+    // calls end_frame, which moves the recorded zones into the retained
+    // frames.
+    class [[nodiscard]] cpu_profiler final
+    {
+    public: // Constants
+        static constexpr size_t zones_per_thread{4096};
+
+    public: // Construction
+        explicit cpu_profiler(size_t retained_frames = 240);
+
+        cpu_profiler(cpu_profiler const&) = delete;
+
+        cpu_profiler(cpu_profiler&&) noexcept = delete;
+
+    public: // Destruction
+        ~cpu_profiler() = default;
+
+    public: // Interface
+        [[nodiscard]] uint64_t now() const noexcept;
+
+        // Zones are dropped while the buffer of the thread is full
+        void record(char const* name, uint64_t begin, uint32_t depth);
+
+        void end_frame();
+
+        // Oldest frame first
+        [[nodiscard]] constexpr std::deque<cpu_frame> const&
+        frames() const noexcept;
+
+        [[nodiscard]] uint64_t dropped_zones() const noexcept;
+
+        // Writes the retained frames in the Chrome trace event format, frames
+        // are on thread 0 and the threads recording zones follow
+        void write_chrome_trace(std::ostream& stream) const;
+
+    public: // Operators
+        cpu_profiler& operator=(cpu_profiler const&) = delete;
+
+        cpu_profiler& operator=(cpu_profiler&&) noexcept = delete;
+
+    private: // Types
+        // Single producer, single consumer ring
+        struct [[nodiscard]] thread_buffer final
+        {
+            uint32_t thread{};
+            std::atomic<size_t> head;
+            std::atomic<size_t> tail;
+            std::atomic<uint64_t> dropped;
+            std::array<cpu_zone, zones_per_thread> zones;
+        };
+
+    private: // Helpers
+        [[nodiscard]] thread_buffer* current_thread_buffer();
+
+    private: // Data
+        std::chrono::steady_clock::time_point start_;
+        size_t retained_frames_;
+        uint64_t frame_begin_{};
+
+        mutable std::mutex buffers_mutex_;
+        std::vector<std::unique_ptr<thread_buffer>> buffers_;
+
+        std::deque<cpu_frame> frames_;
+    };
+
+    // Profiler used by profile_zone
+    [[nodiscard]] cpu_profiler& global_cpu_profiler();
+
+    // Records the lifetime of the object as a zone of the global profiler,
+    // name has to outlive the profiler
+    class [[nodiscard]] profile_zone final
+    {
+    public: // Construction
+        explicit profile_zone(char const* name);
+
+        profile_zone(profile_zone const&) = delete;
+
+        profile_zone(profile_zone&&) noexcept = delete;
+
+    public: // Destruction
+        ~profile_zone();
+
+    public: // Operators
+        profile_zone& operator=(profile_zone const&) = delete;
+
+        profile_zone& operator=(profile_zone&&) noexcept = delete;
+
+    private: // Data
+        char const* name_;
+        uint64_t begin_;
+        uint32_t depth_;
+    };
+} // namespace vkrndr
+
+inline constexpr std::deque<vkrndr::cpu_frame> const&
+vkrndr::cpu_profiler::frames() const noexcept
+{
+    return frames_;
+}
+
+#endif // !VKRNDR_CPU_PROFILER_INCLUDED
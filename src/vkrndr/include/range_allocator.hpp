@@ -0,0 +1,60 @@
+#ifndef VKRNDR_RANGE_ALLOCATOR_INCLUDED
+#define VKRNDR_RANGE_ALLOCATOR_INCLUDED
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vkrndr
+{
+    struct [[nodiscard]] free_range final
+    {
+        uint64_t offset{};
+        uint64_t size{};
+
+        constexpr bool operator==(free_range const&) const = default;
+    };
+
+    // Bookkeeping of the free space in a region of a fixed size, hands out
+    // the first range large enough to hold an aligned allocation
+    class [[nodiscard]] range_allocator final
+    {
+    public: // Construction
+        explicit range_allocator(uint64_t size);
+
+        range_allocator(range_allocator const&) = default;
+
+        range_allocator(range_allocator&&) noexcept = default;
+
+    public: // Destruction
+        ~range_allocator() = default;
+
+    public: // Interface
+        // Returns the offset of the allocation, alignment padding stays free
+        [[nodiscard]] std::optional<uint64_t> allocate(uint64_t size,
+            uint64_t alignment);
+
+        // Range has to be one returned by allocate
+        void free(uint64_t offset, uint64_t size);
+
+        // Sorted by offset, adjacent ranges are always merged
+        [[nodiscard]] constexpr std::vector<free_range> const&
+        free_ranges() const noexcept;
+
+    public: // Operators
+        range_allocator& operator=(range_allocator const&) = default;
+
+        range_allocator& operator=(range_allocator&&) noexcept = default;
+
+    private: // Data
+        std::vector<free_range> free_ranges_;
+    };
+} // namespace vkrndr
+
+inline constexpr std::vector<vkrndr::free_range> const&
+vkrndr::range_allocator::free_ranges() const noexcept
+{
+    return free_ranges_;
+}
+
+#endif // !VKRNDR_RANGE_ALLOCATOR_INCLUDED
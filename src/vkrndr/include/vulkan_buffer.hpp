@@ -0,0 +1,60 @@
+#ifndef VKRNDR_VULKAN_BUFFER_INCLUDED
+#define VKRNDR_VULKAN_BUFFER_INCLUDED
+
+#include <vulkan_memory.hpp>
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstdint>
+#include <span>
+
+namespace vkrndr
+{
+    class vulkan_device;
+} // namespace vkrndr
+
+namespace vkrndr
+{
+    struct [[nodiscard]] vulkan_buffer final
+    {
+        VkBuffer buffer{};
+        memory_allocation allocation;
+    };
+
+    // Host visible buffers prefer device local memory when the device
+    // exposes it as host visible, unless they are host cached for reading
+    // back. Buffers used by more than one queue family are created with
+    // concurrent sharing.
+    vulkan_buffer create_buffer(vulkan_device* device,
+        VkDeviceSize size,
+        VkBufferUsageFlags usage,
+        VkMemoryPropertyFlags memory_properties,
+        std::span<uint32_t const> queue_families = {});
+
+    void destroy(vulkan_device* device, vulkan_buffer* buffer);
+
+    // Memory of host visible buffers stays mapped for their whole lifetime
+    [[nodiscard]] void* map_memory(vulkan_buffer const& buffer);
+
+    // Makes the first size bytes written through the mapped pointer visible
+    // to the device, does nothing for host coherent memory
+    void flush_memory(vulkan_device* device,
+        vulkan_buffer const& buffer,
+        VkDeviceSize size = VK_WHOLE_SIZE);
+
+    // Same as above for size bytes starting offset bytes into the buffer
+    void flush_memory(vulkan_device* device,
+        vulkan_buffer const& buffer,
+        VkDeviceSize offset,
+        VkDeviceSize size);
+
+    // Makes size bytes starting offset bytes into the buffer written by the
+    // device visible through the mapped pointer, does nothing for host
+    // coherent memory
+    void invalidate_memory(vulkan_device* device,
+        vulkan_buffer const& buffer,
+        VkDeviceSize offset,
+        VkDeviceSize size);
+} // namespace vkrndr
+
+#endif // !VKRNDR_VULKAN_BUFFER_INCLUDED
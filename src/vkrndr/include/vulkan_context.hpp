@@ -42,6 +42,8 @@ namespace vkrndr
         VkSurfaceKHR surface_;
     };
 
+    // Without a window the context has no surface, devices created for it
+    // can only render offscreen
     vulkan_context create_context(vulkan_window const* window,
         bool setup_validation_layers);
 } // namespace vkrndr
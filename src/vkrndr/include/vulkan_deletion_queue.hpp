@@ -0,0 +1,88 @@
+#ifndef VKRNDR_VULKAN_DELETION_QUEUE_INCLUDED
+#define VKRNDR_VULKAN_DELETION_QUEUE_INCLUDED
+
+#include <vulkan_buffer.hpp>
+#include <vulkan_memory.hpp>
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace vkrndr
+{
+    class vulkan_device;
+    class vulkan_pipeline;
+} // namespace vkrndr
+
+namespace vkrndr
+{
+    // Takes ownership of device objects which may still be used by submitted
+    // frames and destroys them once those frames completed. Objects are
+    // tagged with the number of the last frame submitted before they were
+    // pushed.
+    class [[nodiscard]] vulkan_deletion_queue final
+    {
+    public: // Construction
+        explicit vulkan_deletion_queue(vulkan_device* device);
+
+        vulkan_deletion_queue(vulkan_deletion_queue const&) = delete;
+
+        vulkan_deletion_queue(vulkan_deletion_queue&&) noexcept = delete;
+
+    public: // Destruction
+        // Destroys everything left, the device mustn't use it anymore
+        ~vulkan_deletion_queue();
+
+    public: // Interface
+        // Objects pushed from now on may be used by frames up to frame
+        void frame_submitted(uint64_t frame) noexcept;
+
+        void push(vulkan_buffer buffer);
+
+        void push(VkImage image, memory_allocation memory);
+
+        void push(VkImageView view);
+
+        // The pool has to allow freeing individual sets
+        void push(VkDescriptorPool pool, VkDescriptorSet set);
+
+        void push(VkDescriptorSetLayout layout);
+
+        void push(std::unique_ptr<vulkan_pipeline> pipeline);
+
+        // Calls destroy at the point an object pushed now would be destroyed
+        void defer(std::move_only_function<void()> destroy);
+
+        // Destroys objects which were only used by frames up to
+        // completed_frame
+        void release(uint64_t completed_frame);
+
+        void release_all();
+
+        [[nodiscard]] size_t size() const noexcept;
+
+    public: // Operators
+        vulkan_deletion_queue& operator=(vulkan_deletion_queue const&) = delete;
+
+        vulkan_deletion_queue& operator=(
+            vulkan_deletion_queue&&) noexcept = delete;
+
+    private: // Types
+        struct [[nodiscard]] entry final
+        {
+            uint64_t frame{};
+            std::move_only_function<void()> destroy;
+        };
+
+    private: // Data
+        vulkan_device* device_;
+        uint64_t submitted_frame_{};
+        std::deque<entry> entries_;
+    };
+} // namespace vkrndr
+
+#endif // !VKRNDR_VULKAN_DELETION_QUEUE_INCLUDED
@@ -4,10 +4,15 @@
 #include <vulkan/vulkan_core.h>
 
 #include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
 
 namespace vkrndr
 {
     class vulkan_context;
+    class vulkan_memory_allocator;
+    class vulkan_pipeline_cache;
 } // namespace vkrndr
 
 namespace vkrndr
@@ -18,7 +23,9 @@ namespace vkrndr
         vulkan_device(VkPhysicalDevice physical_device,
             VkDevice logical_device,
             uint32_t graphics_family,
-            uint32_t present_family);
+            uint32_t present_family,
+            uint32_t transfer_family,
+            std::optional<std::filesystem::path> pipeline_cache_directory);
 
         vulkan_device(vulkan_device const&) = delete;
 
@@ -36,9 +43,30 @@ namespace vkrndr
 
         [[nodiscard]] constexpr uint32_t present_family() const noexcept;
 
+        // Same as the graphics family when the device has no dedicated
+        // transfer queues
+        [[nodiscard]] constexpr uint32_t transfer_family() const noexcept;
+
         [[nodiscard]] constexpr VkSampleCountFlagBits
         max_msaa_samples() const noexcept;
 
+        [[nodiscard]] constexpr VkDeviceSize
+        non_coherent_atom_size() const noexcept;
+
+        [[nodiscard]] constexpr VkDeviceSize
+        storage_buffer_alignment() const noexcept;
+
+        // Nanoseconds per timestamp tick on the graphics queue, zero if it
+        // doesn't support timestamps
+        [[nodiscard]] constexpr float timestamp_period() const noexcept;
+
+        [[nodiscard]] constexpr bool
+        has_pipeline_statistics() const noexcept;
+
+        [[nodiscard]] vulkan_memory_allocator* allocator() const noexcept;
+
+        [[nodiscard]] VkPipelineCache pipeline_cache() const noexcept;
+
     public: // Operators
         vulkan_device& operator=(vulkan_device const&) = delete;
 
@@ -49,10 +77,21 @@ namespace vkrndr
         VkDevice logical_device_{};
         uint32_t graphics_family_{};
         uint32_t present_family_{};
+        uint32_t transfer_family_{};
         VkSampleCountFlagBits max_msaa_samples_{VK_SAMPLE_COUNT_1_BIT};
+        VkDeviceSize non_coherent_atom_size_{1};
+        VkDeviceSize storage_buffer_alignment_{1};
+        float timestamp_period_{};
+        bool pipeline_statistics_{};
+        std::unique_ptr<vulkan_memory_allocator> allocator_;
+        std::unique_ptr<vulkan_pipeline_cache> pipeline_cache_;
     };
 
-    vulkan_device create_device(vulkan_context const& context);
+    // Pipelines built for the device use a cache persisted to a file in
+    // pipeline_cache_directory, or one kept only in memory without it
+    vulkan_device create_device(vulkan_context const& context,
+        std::optional<std::filesystem::path> pipeline_cache_directory =
+            std::nullopt);
 } // namespace vkrndr
 
 inline constexpr VkPhysicalDevice
@@ -77,10 +116,39 @@ inline constexpr uint32_t vkrndr::vulkan_device::present_family() const noexcept
     return present_family_;
 }
 
+inline constexpr uint32_t
+vkrndr::vulkan_device::transfer_family() const noexcept
+{
+    return transfer_family_;
+}
+
 inline constexpr VkSampleCountFlagBits
 vkrndr::vulkan_device::max_msaa_samples() const noexcept
 {
     return max_msaa_samples_;
 }
 
+inline constexpr VkDeviceSize
+vkrndr::vulkan_device::non_coherent_atom_size() const noexcept
+{
+    return non_coherent_atom_size_;
+}
+
+inline constexpr VkDeviceSize
+vkrndr::vulkan_device::storage_buffer_alignment() const noexcept
+{
+    return storage_buffer_alignment_;
+}
+
+inline constexpr float vkrndr::vulkan_device::timestamp_period() const noexcept
+{
+    return timestamp_period_;
+}
+
+inline constexpr bool
+vkrndr::vulkan_device::has_pipeline_statistics() const noexcept
+{
+    return pipeline_statistics_;
+}
+
 #endif // !VKRNDR_VULKAN_DEVICE_INCLUDED
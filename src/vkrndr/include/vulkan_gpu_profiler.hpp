@@ -0,0 +1,141 @@
+#ifndef VKRNDR_VULKAN_GPU_PROFILER_INCLUDED
+#define VKRNDR_VULKAN_GPU_PROFILER_INCLUDED
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vkrndr
+{
+    class vulkan_device;
+} // namespace vkrndr
+
+namespace vkrndr
+{
+    struct [[nodiscard]] gpu_pipeline_statistics final
+    {
+        uint64_t input_vertices{};
+        uint64_t vertex_invocations{};
+        uint64_t clipping_primitives{};
+        uint64_t fragment_invocations{};
+    };
+
+    // GPU time spent on parts of a frame in milliseconds
+    struct [[nodiscard]] gpu_frame_timings final
+    {
+        // Sequence number of the measured frame, counted from one
+        uint64_t frame{};
+        double frame_ms{};
+        std::vector<double> target_ms;
+        double imgui_ms{};
+        // From the end of the UI to the end of rendering, which stores and
+        // resolves the multisampled image
+        double resolve_ms{};
+        std::optional<gpu_pipeline_statistics> target_statistics;
+        std::optional<gpu_pipeline_statistics> imgui_statistics;
+    };
+
+    // Timestamp and pipeline statistics queries with a pool per frame in
+    // flight. Results are read once the frame index comes around again,
+    // when the GPU finished the frame, without waiting for them. Does
+    // nothing if the graphics queue doesn't support timestamps.
+    class [[nodiscard]] vulkan_gpu_profiler final
+    {
+    public: // Construction
+        vulkan_gpu_profiler(vulkan_device* device,
+            uint32_t frames_in_flight,
+            uint32_t max_targets);
+
+        vulkan_gpu_profiler(vulkan_gpu_profiler const&) = delete;
+
+        vulkan_gpu_profiler(vulkan_gpu_profiler&&) noexcept = delete;
+
+    public: // Destruction
+        ~vulkan_gpu_profiler();
+
+    public: // Interface
+        [[nodiscard]] bool enabled() const noexcept;
+
+        // Reads the results of the frame previously recorded with
+        // frame_index if they are available
+        void collect(uint32_t frame_index);
+
+        // Resets the queries of frame_index, has to be recorded outside of
+        // rendering before anything else is measured
+        void begin_frame(VkCommandBuffer command_buffer, uint32_t frame_index);
+
+        // Target commands are recorded once and replayed, target_count is
+        // the number of targets in the replayed commands
+        void end_frame(VkCommandBuffer command_buffer,
+            uint32_t frame_index,
+            uint32_t target_count);
+
+        // Recorded after rendering ended in the primary command buffer
+        void end_rendering(VkCommandBuffer command_buffer,
+            uint32_t frame_index);
+
+        // Targets past max_targets aren't measured
+        void begin_target(VkCommandBuffer command_buffer,
+            uint32_t frame_index,
+            uint32_t target);
+
+        void end_target(VkCommandBuffer command_buffer,
+            uint32_t frame_index,
+            uint32_t target);
+
+        // Statistics of all targets are gathered in a single query
+        void begin_targets(VkCommandBuffer command_buffer,
+            uint32_t frame_index);
+
+        void end_targets(VkCommandBuffer command_buffer, uint32_t frame_index);
+
+        void begin_imgui(VkCommandBuffer command_buffer, uint32_t frame_index);
+
+        void end_imgui(VkCommandBuffer command_buffer, uint32_t frame_index);
+
+        // Last collected results, frames are a few frames behind
+        [[nodiscard]] constexpr std::optional<gpu_frame_timings> const&
+        latest() const noexcept;
+
+    public: // Operators
+        vulkan_gpu_profiler& operator=(vulkan_gpu_profiler const&) = delete;
+
+        vulkan_gpu_profiler& operator=(
+            vulkan_gpu_profiler&&) noexcept = delete;
+
+    private: // Types
+        struct [[nodiscard]] frame_data final
+        {
+            VkQueryPool timestamps{};
+            VkQueryPool statistics{};
+            std::optional<uint32_t> target_count;
+            uint64_t frame{};
+        };
+
+    private: // Helpers
+        void write_timestamp(VkCommandBuffer command_buffer,
+            uint32_t frame_index,
+            VkPipelineStageFlags2 stage,
+            uint32_t query) const;
+
+        [[nodiscard]] double milliseconds(uint64_t begin,
+            uint64_t end) const noexcept;
+
+    private: // Data
+        vulkan_device* device_;
+        uint32_t max_targets_;
+        std::vector<frame_data> frames_;
+        uint64_t recorded_frames_{};
+        std::optional<gpu_frame_timings> latest_;
+    };
+} // namespace vkrndr
+
+inline constexpr std::optional<vkrndr::gpu_frame_timings> const&
+vkrndr::vulkan_gpu_profiler::latest() const noexcept
+{
+    return latest_;
+}
+
+#endif // !VKRNDR_VULKAN_GPU_PROFILER_INCLUDED
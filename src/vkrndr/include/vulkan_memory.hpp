@@ -0,0 +1,115 @@
+#ifndef VKRNDR_VULKAN_MEMORY_INCLUDED
+#define VKRNDR_VULKAN_MEMORY_INCLUDED
+
+#include <range_allocator.hpp>
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vkrndr
+{
+    struct [[nodiscard]] memory_allocation final
+    {
+        VkDeviceMemory memory{};
+        VkDeviceSize offset{};
+        VkDeviceSize size{};
+        VkMemoryPropertyFlags properties{};
+        // Points to offset within the memory, null if it isn't host visible
+        std::byte* mapped{};
+    };
+
+    struct [[nodiscard]] memory_statistics final
+    {
+        uint32_t block_count{};
+        uint32_t allocation_count{};
+        VkDeviceSize reserved_bytes{};
+        VkDeviceSize used_bytes{};
+    };
+
+    // Reserves large blocks of device memory per memory type and hands out
+    // aligned ranges from them. Host visible blocks are mapped once, when
+    // they are allocated.
+    class [[nodiscard]] vulkan_memory_allocator final
+    {
+    public: // Constants
+        static constexpr VkDeviceSize default_block_size{16 * 1024 * 1024};
+
+    public: // Construction
+        vulkan_memory_allocator(VkPhysicalDevice physical_device,
+            VkDevice logical_device,
+            VkDeviceSize non_coherent_atom_size,
+            VkDeviceSize block_size = default_block_size);
+
+        vulkan_memory_allocator(vulkan_memory_allocator const&) = delete;
+
+        vulkan_memory_allocator(vulkan_memory_allocator&&) noexcept = delete;
+
+    public: // Destruction
+        ~vulkan_memory_allocator();
+
+    public: // Interface
+        // Uses a memory type with all required properties, one which also has
+        // the preferred properties if there is one. Buffers and linear images
+        // are kept in separate blocks from optimal images, so
+        // bufferImageGranularity never has to be considered.
+        [[nodiscard]] memory_allocation allocate(
+            VkMemoryRequirements const& requirements,
+            VkMemoryPropertyFlags required,
+            VkMemoryPropertyFlags preferred,
+            bool linear);
+
+        void free(memory_allocation const& allocation);
+
+        [[nodiscard]] memory_statistics statistics() const;
+
+    public: // Operators
+        vulkan_memory_allocator& operator=(
+            vulkan_memory_allocator const&) = delete;
+
+        vulkan_memory_allocator& operator=(
+            vulkan_memory_allocator&&) noexcept = delete;
+
+    private: // Types
+        struct [[nodiscard]] memory_block final
+        {
+            VkDeviceMemory memory{};
+            VkDeviceSize size{};
+            uint32_t memory_type{};
+            bool linear{};
+            bool dedicated{};
+            std::byte* mapped{};
+            uint32_t allocation_count{};
+            VkDeviceSize used_bytes{};
+            range_allocator ranges{0};
+        };
+
+    private: // Helpers
+        [[nodiscard]] uint32_t select_memory_type(uint32_t type_bits,
+            VkMemoryPropertyFlags required,
+            VkMemoryPropertyFlags preferred) const;
+
+        [[nodiscard]] memory_block& allocate_block(uint32_t memory_type,
+            VkDeviceSize size,
+            bool linear,
+            bool dedicated);
+
+        void free_block(memory_block const& block);
+
+    private: // Data
+        VkPhysicalDevice physical_device_{};
+        VkDevice logical_device_{};
+        VkDeviceSize non_coherent_atom_size_{};
+        VkDeviceSize block_size_{};
+        VkPhysicalDeviceMemoryProperties memory_properties_{};
+
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<memory_block>> blocks_;
+    };
+} // namespace vkrndr
+
+#endif // !VKRNDR_VULKAN_MEMORY_INCLUDED
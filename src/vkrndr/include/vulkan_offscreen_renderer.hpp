@@ -0,0 +1,174 @@
+#ifndef VKRNDR_VULKAN_OFFSCREEN_RENDERER_INCLUDED
+#define VKRNDR_VULKAN_OFFSCREEN_RENDERER_INCLUDED
+
+#include <vulkan_buffer.hpp>
+#include <vulkan_deletion_queue.hpp>
+#include <vulkan_memory.hpp>
+#include <vulkan_render_target.hpp>
+#include <vulkan_uploader.hpp>
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace vkrndr
+{
+    class vulkan_device;
+} // namespace vkrndr
+
+namespace vkrndr
+{
+    // Pixels of a frame rendered by vulkan_offscreen_renderer as tightly
+    // packed rows in the renderer's image format, valid until the frame is
+    // overwritten frames_in_flight frames later
+    struct [[nodiscard]] offscreen_frame final
+    {
+        uint64_t index{};
+        VkExtent2D extent{};
+        std::span<std::byte const> pixels;
+    };
+
+    // Renders targets into device images without a window or a swap chain.
+    // Every frame in flight has its own image and a host visible buffer the
+    // image is copied to, reading a frame only waits for that frame on a
+    // timeline semaphore.
+    class [[nodiscard]] vulkan_offscreen_renderer final
+    {
+    public: // Construction
+        vulkan_offscreen_renderer(vulkan_device* device,
+            VkExtent2D extent,
+            uint32_t frames_in_flight);
+
+        vulkan_offscreen_renderer(vulkan_offscreen_renderer const&) = delete;
+
+        vulkan_offscreen_renderer(
+            vulkan_offscreen_renderer&&) noexcept = delete;
+
+    public: // Destruction
+        ~vulkan_offscreen_renderer();
+
+    public: // Interface
+        [[nodiscard]] constexpr VkFormat image_format() const noexcept;
+
+        [[nodiscard]] constexpr VkExtent2D extent() const noexcept;
+
+        [[nodiscard]] uint32_t frames_in_flight() const noexcept;
+
+        [[nodiscard]] constexpr VkDescriptorPool
+        descriptor_pool() const noexcept;
+
+        [[nodiscard]] constexpr vulkan_uploader* uploader() noexcept;
+
+        // Frame numbers of the queue are the values of timeline
+        [[nodiscard]] constexpr vulkan_deletion_queue*
+        deletion_queue() noexcept;
+
+        // Reaches frame + 1 once frame is rendered and copied
+        [[nodiscard]] constexpr VkSemaphore timeline() const noexcept;
+
+        // Renders targets and queues the copy of the image for readback,
+        // returns the index of the frame. Waits for the frame rendered
+        // frames_in_flight frames earlier, which is overwritten.
+        uint64_t draw(std::span<vulkan_render_target const*> targets);
+
+        [[nodiscard]] bool is_ready(uint64_t frame) const;
+
+        // Waits until the pixels of frame are available
+        [[nodiscard]] offscreen_frame read(uint64_t frame) const;
+
+    public: // Operators
+        vulkan_offscreen_renderer& operator=(
+            vulkan_offscreen_renderer const&) = delete;
+
+        vulkan_offscreen_renderer& operator=(
+            vulkan_offscreen_renderer&&) noexcept = delete;
+
+    private: // Types
+        struct [[nodiscard]] frame_data final
+        {
+            VkImage image{};
+            memory_allocation image_memory;
+            VkImageView image_view{};
+            vulkan_buffer readback;
+            VkCommandBuffer command_buffer{};
+            VkCommandBuffer target_command_buffer{};
+            std::vector<recorded_target> recorded_targets;
+            std::optional<uint64_t> index;
+        };
+
+    private: // Helpers
+        [[nodiscard]] frame_data const& rendered_frame(uint64_t frame) const;
+
+        void record_target_commands(frame_data& frame,
+            uint32_t frame_index,
+            std::span<vulkan_render_target const*> targets);
+
+        void record_command_buffer(frame_data const& frame, bool has_targets);
+
+        [[nodiscard]] bool is_multisampled() const;
+
+        [[nodiscard]] VkDeviceSize image_size() const;
+
+    private: // Data
+        vulkan_device* device_;
+        VkExtent2D extent_;
+        VkQueue queue_{};
+        VkCommandPool command_pool_{};
+        VkDescriptorPool descriptor_pool_{};
+
+        vulkan_uploader uploader_;
+
+        vulkan_deletion_queue deletion_queue_;
+
+        VkSemaphore timeline_{};
+
+        VkImage color_image_{};
+        VkImageView color_image_view_{};
+        memory_allocation color_image_memory_;
+
+        std::vector<frame_data> frames_;
+        uint64_t next_frame_{};
+    };
+} // namespace vkrndr
+
+inline constexpr VkFormat
+vkrndr::vulkan_offscreen_renderer::image_format() const noexcept
+{
+    return VK_FORMAT_R8G8B8A8_UNORM;
+}
+
+inline constexpr VkExtent2D
+vkrndr::vulkan_offscreen_renderer::extent() const noexcept
+{
+    return extent_;
+}
+
+inline constexpr VkDescriptorPool
+vkrndr::vulkan_offscreen_renderer::descriptor_pool() const noexcept
+{
+    return descriptor_pool_;
+}
+
+inline constexpr vkrndr::vulkan_uploader*
+vkrndr::vulkan_offscreen_renderer::uploader() noexcept
+{
+    return &uploader_;
+}
+
+inline constexpr vkrndr::vulkan_deletion_queue*
+vkrndr::vulkan_offscreen_renderer::deletion_queue() noexcept
+{
+    return &deletion_queue_;
+}
+
+inline constexpr VkSemaphore
+vkrndr::vulkan_offscreen_renderer::timeline() const noexcept
+{
+    return timeline_;
+}
+
+#endif // !VKRNDR_VULKAN_OFFSCREEN_RENDERER_INCLUDED
@@ -3,6 +3,8 @@
 
 #include <vulkan/vulkan_core.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <span>
@@ -68,6 +70,10 @@ namespace vkrndr
             std::filesystem::path const& path,
             std::string_view entry_point);
 
+        vulkan_pipeline_builder& add_shader(VkShaderStageFlagBits stage,
+            std::span<uint32_t const> code,
+            std::string_view entry_point);
+
         vulkan_pipeline_builder& add_vertex_input(
             std::span<VkVertexInputBindingDescription const>
                 binding_descriptions,
@@ -83,6 +89,19 @@ namespace vkrndr
         vulkan_pipeline_builder& with_push_constants(
             VkPushConstantRange push_constants);
 
+        // Specializes constant_id of every shader of stages, regardless of
+        // whether the shader was added before or after
+        vulkan_pipeline_builder& add_specialization_constant(
+            VkShaderStageFlags stages,
+            uint32_t constant_id,
+            std::span<std::byte const> value);
+
+        template<typename T>
+        vulkan_pipeline_builder& add_specialization_constant(
+            VkShaderStageFlags stages,
+            uint32_t constant_id,
+            T const& value);
+
     public: // Operators
         vulkan_pipeline_builder& operator=(
             vulkan_pipeline_builder const&) = delete;
@@ -90,6 +109,13 @@ namespace vkrndr
         vulkan_pipeline_builder& operator=(
             vulkan_pipeline_builder&&) noexcept = delete;
 
+    private: // Types
+        struct [[nodiscard]] specialization_constant final
+        {
+            VkShaderStageFlags stages{};
+            VkSpecializationMapEntry entry{};
+        };
+
     private: // Helpers
         void cleanup();
 
@@ -104,6 +130,8 @@ namespace vkrndr
         std::vector<VkDescriptorSetLayout> descriptor_set_layouts_;
         VkSampleCountFlagBits rasterization_samples_{VK_SAMPLE_COUNT_1_BIT};
         std::optional<VkPushConstantRange> push_constants_;
+        std::vector<specialization_constant> specialization_constants_;
+        std::vector<std::byte> specialization_data_;
     };
 } // namespace vkrndr
 
@@ -118,4 +146,16 @@ vkrndr::vulkan_pipeline::pipeline_layout() const noexcept
     return pipeline_layout_;
 }
 
+template<typename T>
+vkrndr::vulkan_pipeline_builder&
+vkrndr::vulkan_pipeline_builder::add_specialization_constant(
+    VkShaderStageFlags const stages,
+    uint32_t const constant_id,
+    T const& value)
+{
+    return add_specialization_constant(stages,
+        constant_id,
+        std::as_bytes(std::span{&value, 1}));
+}
+
 #endif // !VKRNDR_VULKAN_PIPELINE_INCLUDED
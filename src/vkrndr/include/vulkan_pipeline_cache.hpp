@@ -0,0 +1,59 @@
+#ifndef VKRNDR_VULKAN_PIPELINE_CACHE_INCLUDED
+#define VKRNDR_VULKAN_PIPELINE_CACHE_INCLUDED
+
+#include <vulkan/vulkan_core.h>
+
+#include <filesystem>
+#include <optional>
+
+namespace vkrndr
+{
+    // Pipeline cache persisted to a file between runs. Each device and
+    // driver version gets its own file in the directory, named after the
+    // device UUID. The file additionally records the vendor, device, driver
+    // version and pipeline cache UUID it was created with together with a
+    // checksum of the data, files which don't match the current device or
+    // fail the checksum are ignored.
+    class [[nodiscard]] vulkan_pipeline_cache final
+    {
+    public: // Construction
+        vulkan_pipeline_cache(VkPhysicalDevice physical_device,
+            VkDevice logical_device,
+            std::optional<std::filesystem::path> const& directory);
+
+        vulkan_pipeline_cache(vulkan_pipeline_cache const&) = delete;
+
+        vulkan_pipeline_cache(vulkan_pipeline_cache&&) noexcept = delete;
+
+    public: // Destruction
+        // Saves the cache, failures are only logged
+        ~vulkan_pipeline_cache();
+
+    public: // Interface
+        [[nodiscard]] constexpr VkPipelineCache cache() const noexcept;
+
+        // Writes the cache to its file, if it has one
+        void save() const;
+
+    public: // Operators
+        vulkan_pipeline_cache& operator=(
+            vulkan_pipeline_cache const&) = delete;
+
+        vulkan_pipeline_cache& operator=(
+            vulkan_pipeline_cache&&) noexcept = delete;
+
+    private: // Data
+        VkPhysicalDeviceProperties properties_{};
+        VkDevice logical_device_{};
+        std::optional<std::filesystem::path> file_;
+        VkPipelineCache cache_{};
+    };
+} // namespace vkrndr
+
+inline constexpr VkPipelineCache
+vkrndr::vulkan_pipeline_cache::cache() const noexcept
+{
+    return cache_;
+}
+
+#endif // !VKRNDR_VULKAN_PIPELINE_CACHE_INCLUDED
@@ -4,10 +4,13 @@
 #include <vulkan/vulkan_core.h>
 
 #include <cstdint>
+#include <span>
 
 namespace vkrndr
 {
+    class vulkan_deletion_queue;
     class vulkan_device;
+    class vulkan_uploader;
 } // namespace vkrndr
 
 namespace vkrndr
@@ -25,17 +28,34 @@ namespace vkrndr
         virtual ~vulkan_render_target() = default;
 
     public: // Interface
+        // Resources released on detach are pushed to deletion_queue, frames
+        // still in flight may use them
         void attach_renderer(vulkan_device* vulkan_device,
             VkDescriptorPool descriptor_pool,
+            vulkan_uploader* uploader,
+            vulkan_deletion_queue* deletion_queue,
             VkFormat image_format,
             uint32_t frames_in_flight);
 
+        // Writes the data read by the commands recorded for frame_index,
+        // called every frame before they are executed
+        void update(uint32_t frame_index) const;
+
+        // Records into a secondary command buffer which is executed every
+        // frame until the renderer is recreated or the generation changes,
+        // anything changing between frames has to be read from buffers
+        // written by update
         void render(VkCommandBuffer command_buffer,
             VkExtent2D extent,
             uint32_t frame_index) const;
 
         void detach_renderer();
 
+        // Changes whenever commands recorded by render may refer to
+        // destroyed resources. Values are unique across all targets, so a
+        // different target at the address of a destroyed one never matches.
+        [[nodiscard]] constexpr uint64_t generation() const noexcept;
+
     public: // Operators
         vulkan_render_target& operator=(vulkan_render_target const&) = delete;
 
@@ -46,16 +66,46 @@ namespace vkrndr
         virtual void attach_renderer_impl(VkFormat image_format,
             uint32_t frames_in_flight) = 0;
 
+        virtual void update_impl(uint32_t frame_index) const = 0;
+
         virtual void render_impl(VkCommandBuffer command_buffer,
             VkExtent2D extent,
             uint32_t frame_index) const = 0;
 
         virtual void detach_renderer_impl() = 0;
 
+    protected: // Helpers
+        // Has to be called when resources used by recorded commands are
+        // replaced while the renderer is attached
+        void invalidate_commands() noexcept;
+
     protected: // Data
         vulkan_device* vulkan_device_{};
         VkDescriptorPool descriptor_pool_{};
+        vulkan_uploader* uploader_{};
+        vulkan_deletion_queue* deletion_queue_{};
+
+    private: // Data
+        uint64_t generation_{};
     };
+
+    // Target and its generation when its commands were recorded
+    struct [[nodiscard]] recorded_target final
+    {
+        vulkan_render_target const* target{};
+        uint64_t generation{};
+    };
+
+    // Whether commands recorded for recorded can be replayed for targets
+    [[nodiscard]] bool is_recording_current(
+        std::span<recorded_target const> recorded,
+        std::span<vulkan_render_target const* const> targets);
 } // namespace vkrndr
 
+inline constexpr uint64_t
+vkrndr::vulkan_render_target::generation() const noexcept
+{
+    return generation_;
+}
+
 #endif // !VKRNDR_VULKAN_RENDER_TARGET_INCLUDED
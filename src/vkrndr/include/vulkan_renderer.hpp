@@ -1,6 +1,12 @@
 #ifndef VKRNDR_VULKAN_RENDERER_INCLUDED
 #define VKRNDR_VULKAN_RENDERER_INCLUDED
 
+#include <vulkan_deletion_queue.hpp>
+#include <vulkan_gpu_profiler.hpp>
+#include <vulkan_memory.hpp>
+#include <vulkan_render_target.hpp>
+#include <vulkan_uploader.hpp>
+
 #include <vulkan/vulkan_core.h>
 
 #include <cstdint>
@@ -11,7 +17,6 @@ namespace vkrndr
 {
     class vulkan_context;
     class vulkan_device;
-    class vulkan_render_target;
     class vulkan_swap_chain;
     class vulkan_window;
 } // namespace vkrndr
@@ -37,8 +42,29 @@ namespace vkrndr
         [[nodiscard]] constexpr VkDescriptorPool
         descriptor_pool() const noexcept;
 
+        [[nodiscard]] constexpr vulkan_uploader* uploader() noexcept;
+
+        // Resources pushed here are destroyed once frames submitted so far
+        // completed
+        [[nodiscard]] constexpr vulkan_deletion_queue*
+        deletion_queue() noexcept;
+
+        [[nodiscard]] constexpr vulkan_gpu_profiler const*
+        gpu_profiler() const noexcept;
+
+        [[nodiscard]] uint32_t frames_in_flight() const noexcept;
+
+        // Whether draw can start without waiting for the GPU to finish an
+        // earlier frame
+        [[nodiscard]] bool is_frame_available() const;
+
+        // Commands of targets are recorded once per frame in flight and
+        // replayed until the set of targets or the generation of one of them
+        // changes, or recreate is called
         void draw(std::span<vulkan_render_target const*> targets);
 
+        // Creates the multisampled target for the current swap chain extent,
+        // the previous one is destroyed once frames using it retired
         void recreate();
 
     public: // Operators
@@ -49,6 +75,11 @@ namespace vkrndr
     private: // Helpers
         void init_imgui();
 
+        void record_target_commands(
+            std::span<vulkan_render_target const*> targets);
+
+        void record_imgui_commands();
+
         void record_command_buffer(
             std::span<vulkan_render_target const*> targets,
             VkCommandBuffer& command_buffer,
@@ -66,14 +97,27 @@ namespace vkrndr
 
         VkCommandPool command_pool_{};
         std::vector<VkCommandBuffer> command_buffers_{};
+        std::vector<VkCommandBuffer> target_command_buffers_{};
+        std::vector<VkCommandBuffer> imgui_command_buffers_{};
+        // Targets recorded into target_command_buffers_ of each frame in
+        // flight, empty if they have to be recorded again
+        std::vector<std::vector<recorded_target>> recorded_targets_;
 
         VkDescriptorPool descriptor_pool_{};
 
+        vulkan_uploader uploader_;
+
+        vulkan_deletion_queue deletion_queue_;
+
+        vulkan_gpu_profiler gpu_profiler_;
+
         VkImage color_image_{};
         VkImageView color_image_view_{};
-        VkDeviceMemory color_image_memory_{};
+        memory_allocation color_image_memory_;
 
         uint32_t current_frame_{};
+        // Zero until ImGui is initialized
+        uint32_t imgui_min_image_count_{};
     };
 } // namespace vkrndr
 
@@ -83,4 +127,22 @@ vkrndr::vulkan_renderer::descriptor_pool() const noexcept
     return descriptor_pool_;
 }
 
+inline constexpr vkrndr::vulkan_uploader*
+vkrndr::vulkan_renderer::uploader() noexcept
+{
+    return &uploader_;
+}
+
+inline constexpr vkrndr::vulkan_deletion_queue*
+vkrndr::vulkan_renderer::deletion_queue() noexcept
+{
+    return &deletion_queue_;
+}
+
+inline constexpr vkrndr::vulkan_gpu_profiler const*
+vkrndr::vulkan_renderer::gpu_profiler() const noexcept
+{
+    return &gpu_profiler_;
+}
+
 #endif // !VKRNDR_VULKAN_RENDERER_INCLUDED
@@ -6,6 +6,8 @@
 #include <vulkan_utility.hpp>
 
 #include <cstdint>
+#include <optional>
+#include <span>
 #include <vector>
 
 namespace vkrndr
@@ -27,15 +29,26 @@ namespace vkrndr
     swap_chain_support query_swap_chain_support(VkPhysicalDevice device,
         VkSurfaceKHR surface);
 
-    class [[nodiscard]] vulkan_swap_chain final
+    struct [[nodiscard]] swap_chain_settings final
     {
-    public: // Constants
-        static constexpr int max_frames_in_flight{2};
+        uint32_t frames_in_flight{2};
+        // Clamped to the limits of the surface, one more than the minimum
+        // when not set
+        std::optional<uint32_t> image_count;
+        // FIFO is used when the surface doesn't support the mode
+        VkPresentModeKHR present_mode{VK_PRESENT_MODE_MAILBOX_KHR};
+    };
 
+    // Frames are numbered from 1 in submission order. A timeline semaphore
+    // of the graphics queue reaches the number of each frame once it's
+    // rendered, so completion can be queried without blocking.
+    class [[nodiscard]] vulkan_swap_chain final
+    {
     public: // Construction
         vulkan_swap_chain(vulkan_window* window,
             vulkan_context* context,
-            vulkan_device* device);
+            vulkan_device* device,
+            swap_chain_settings const& settings = {});
 
         vulkan_swap_chain(vulkan_swap_chain const&) = delete;
 
@@ -57,19 +70,45 @@ namespace vkrndr
 
         [[nodiscard]] constexpr uint32_t image_count() const noexcept;
 
+        [[nodiscard]] constexpr uint32_t frames_in_flight() const noexcept;
+
+        [[nodiscard]] constexpr VkPresentModeKHR present_mode() const noexcept;
+
         [[nodiscard]] constexpr VkImage image(
             uint32_t image_index) const noexcept;
 
         [[nodiscard]] constexpr VkImageView image_view(
             uint32_t image_index) const noexcept;
 
+        // Waits for the frame previously submitted with current_frame
         [[nodiscard]] bool acquire_next_image(uint32_t current_frame,
             uint32_t& image_index);
 
-        void submit_command_buffer(VkCommandBuffer const* command_buffer,
+        // Whether acquiring an image for current_frame won't wait for the GPU
+        [[nodiscard]] bool is_frame_available(uint32_t current_frame) const;
+
+        [[nodiscard]] bool is_frame_complete(uint64_t frame) const;
+
+        // Number of the last frame the GPU finished
+        [[nodiscard]] uint64_t completed_frame() const;
+
+        void wait_for_frame(uint64_t frame) const;
+
+        [[nodiscard]] constexpr VkSemaphore frame_timeline() const noexcept;
+
+        // Number of the last submitted frame, zero before the first one
+        [[nodiscard]] constexpr uint64_t submitted_frame() const noexcept;
+
+        // Execution additionally waits for timeline to reach timeline_value
+        // when a timeline semaphore is given. Returns the frame number.
+        uint64_t submit_command_buffer(VkCommandBuffer const* command_buffer,
             uint32_t current_frame,
-            uint32_t image_index);
+            uint32_t image_index,
+            VkSemaphore timeline = VK_NULL_HANDLE,
+            uint64_t timeline_value = 0);
 
+        // Creates a new chain from the current one without waiting for the
+        // device, the old chain is destroyed once its last frame retired
         void recreate();
 
     public: // Operators
@@ -77,8 +116,21 @@ namespace vkrndr
 
         vulkan_swap_chain& operator=(vulkan_swap_chain&& other) noexcept;
 
+    private: // Types
+        struct [[nodiscard]] retired_chain final
+        {
+            VkSwapchainKHR chain{};
+            std::vector<VkImageView> image_views;
+            uint64_t frame{};
+        };
+
     private: // Helpers
-        void create_chain_and_images();
+        void create_chain_and_images(VkSwapchainKHR old_chain);
+
+        void destroy_chain(VkSwapchainKHR chain,
+            std::span<VkImageView const> image_views);
+
+        void release_retired_chains();
 
         void cleanup();
 
@@ -89,7 +141,7 @@ namespace vkrndr
             vulkan_device* device_{};
             VkSemaphore image_available{};
             VkSemaphore render_finished{};
-            VkFence in_flight{};
+            uint64_t frame{};
 
         public: // Construction
             explicit image_sync(vkrndr::vulkan_device* device);
@@ -108,13 +160,18 @@ namespace vkrndr
         vulkan_window* window_{};
         vulkan_context* context_{};
         vulkan_device* device_{};
+        swap_chain_settings settings_;
         VkFormat image_format_{};
+        VkPresentModeKHR present_mode_{};
         uint32_t min_image_count_{};
         VkExtent2D extent_{};
         VkSwapchainKHR chain_{};
         std::vector<VkImage> images_;
         std::vector<VkImageView> image_views_;
+        std::vector<retired_chain> retired_chains_;
         std::vector<image_sync> image_syncs_;
+        VkSemaphore frame_timeline_{};
+        uint64_t submitted_frame_{};
 
         VkQueue graphics_queue_{};
         VkQueue present_queue_{};
@@ -157,6 +214,30 @@ vkrndr::vulkan_swap_chain::image_count() const noexcept
     return vkrndr::count_cast(images_.size());
 }
 
+inline constexpr uint32_t
+vkrndr::vulkan_swap_chain::frames_in_flight() const noexcept
+{
+    return settings_.frames_in_flight;
+}
+
+inline constexpr VkPresentModeKHR
+vkrndr::vulkan_swap_chain::present_mode() const noexcept
+{
+    return present_mode_;
+}
+
+inline constexpr VkSemaphore
+vkrndr::vulkan_swap_chain::frame_timeline() const noexcept
+{
+    return frame_timeline_;
+}
+
+inline constexpr uint64_t
+vkrndr::vulkan_swap_chain::submitted_frame() const noexcept
+{
+    return submitted_frame_;
+}
+
 inline constexpr VkImage vkrndr::vulkan_swap_chain::image(
     uint32_t const image_index) const noexcept
 {
@@ -0,0 +1,117 @@
+#ifndef VKRNDR_VULKAN_UPLOADER_INCLUDED
+#define VKRNDR_VULKAN_UPLOADER_INCLUDED
+
+#include <vulkan_buffer.hpp>
+
+#include <vulkan/vulkan_core.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+namespace vkrndr
+{
+    class vulkan_device;
+} // namespace vkrndr
+
+namespace vkrndr
+{
+    // Copies data to device local memory through a host visible staging
+    // ring. Copies are recorded into batches executed on the transfer queue,
+    // each submitted batch signals the next value of a timeline semaphore.
+    class [[nodiscard]] vulkan_uploader final
+    {
+    public: // Construction
+        vulkan_uploader(vulkan_device* device, VkDeviceSize staging_size);
+
+        vulkan_uploader(vulkan_uploader const&) = delete;
+
+        vulkan_uploader(vulkan_uploader&&) noexcept = delete;
+
+    public: // Destruction
+        ~vulkan_uploader();
+
+    public: // Interface
+        // Creates a device local buffer usable by both the graphics and the
+        // transfer queue and queues a copy of data into it
+        [[nodiscard]] vulkan_buffer create_buffer(VkBufferUsageFlags usage,
+            std::span<std::byte const> data);
+
+        void upload(vulkan_buffer const& destination,
+            VkDeviceSize offset,
+            std::span<std::byte const> data);
+
+        // Copies tightly packed texels to the first mip level of image and
+        // leaves it in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL. The image
+        // has to be created with queue_families() when they differ.
+        void upload(VkImage image,
+            VkExtent2D extent,
+            std::span<std::byte const> data);
+
+        // Submits queued copies, returns the semaphore value signaled once
+        // they are complete
+        uint64_t submit();
+
+        void wait(uint64_t value) const;
+
+        [[nodiscard]] std::span<uint32_t const> queue_families() const;
+
+        [[nodiscard]] constexpr VkSemaphore semaphore() const noexcept;
+
+        [[nodiscard]] constexpr uint64_t submitted_value() const noexcept;
+
+    public: // Operators
+        vulkan_uploader& operator=(vulkan_uploader const&) = delete;
+
+        vulkan_uploader& operator=(vulkan_uploader&&) noexcept = delete;
+
+    private: // Types
+        struct [[nodiscard]] batch final
+        {
+            VkCommandBuffer command_buffer{};
+            uint64_t value{};
+            VkDeviceSize staging_begin{};
+        };
+
+    private: // Helpers
+        [[nodiscard]] VkDeviceSize stage(std::span<std::byte const> data);
+
+        [[nodiscard]] VkCommandBuffer recording_buffer();
+
+        void retire_completed();
+
+    private: // Data
+        vulkan_device* device_;
+        VkDeviceSize staging_size_;
+        std::array<uint32_t, 2> queue_families_{};
+        VkQueue queue_{};
+        VkCommandPool command_pool_{};
+        VkSemaphore semaphore_{};
+
+        vulkan_buffer staging_;
+        std::byte* staging_map_{};
+        VkDeviceSize staging_head_{};
+
+        VkCommandBuffer recording_{};
+        VkDeviceSize recording_begin_{};
+        std::deque<batch> in_flight_;
+        std::vector<VkCommandBuffer> free_command_buffers_;
+        uint64_t submitted_value_{};
+    };
+} // namespace vkrndr
+
+inline constexpr VkSemaphore vkrndr::vulkan_uploader::semaphore() const noexcept
+{
+    return semaphore_;
+}
+
+inline constexpr uint64_t
+vkrndr::vulkan_uploader::submitted_value() const noexcept
+{
+    return submitted_value_;
+}
+
+#endif // !VKRNDR_VULKAN_UPLOADER_INCLUDED
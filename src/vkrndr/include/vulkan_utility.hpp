@@ -1,16 +1,24 @@
 #ifndef VKRNDR_VULKAN_UTILITY_INCLUDED
 #define VKRNDR_VULKAN_UTILITY_INCLUDED
 
+#include <vulkan_memory.hpp>
+
 #include <vulkan/vulkan_core.h>
 
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <optional>
 #include <span>
 #include <utility>
 #include <vector>
 
+namespace vkrndr
+{
+    class vulkan_device;
+} // namespace vkrndr
+
 namespace vkrndr
 {
     [[nodiscard]] uint32_t find_memory_type(VkPhysicalDevice physical_device,
@@ -41,8 +49,7 @@ namespace vkrndr
             elements.value_or(value.size()) * sizeof(T)};
     }
 
-    void create_image(VkPhysicalDevice physical_device,
-        VkDevice device,
+    void create_image(vulkan_device* device,
         VkExtent2D extent,
         uint32_t mip_levels,
         VkSampleCountFlagBits samples,
@@ -51,13 +58,26 @@ namespace vkrndr
         VkImageUsageFlags usage,
         VkMemoryPropertyFlags properties,
         VkImage& image,
-        VkDeviceMemory& image_memory);
+        memory_allocation& image_memory,
+        std::span<uint32_t const> queue_families = {});
 
     [[nodiscard]] VkImageView create_image_view(VkDevice device,
         VkImage image,
         VkFormat format,
         VkImageAspectFlags aspect_flags,
         uint32_t mip_levels);
+
+    [[nodiscard]] VkSemaphore create_timeline_semaphore(
+        vulkan_device const* device);
+
+    [[nodiscard]] uint64_t semaphore_value(vulkan_device const* device,
+        VkSemaphore timeline);
+
+    // Returns false if the timeout, in nanoseconds, elapsed first
+    bool wait_semaphore(vulkan_device const* device,
+        VkSemaphore timeline,
+        uint64_t value,
+        uint64_t timeout = std::numeric_limits<uint64_t>::max());
 } // namespace vkrndr
 
 #endif // !VKRNDR_VULKAN_UTILITY_INCLUDED
@@ -0,0 +1,191 @@
+#include <cpu_profiler.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+    // Zones of the calling thread which are currently open
+    thread_local uint32_t open_zones{};
+
+    [[nodiscard]] std::string json_escape(char const* const text)
+    {
+        std::string rv;
+        for (char const* c{text}; *c != '\0'; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                rv.push_back('\\');
+            }
+            rv.push_back(*c);
+        }
+        return rv;
+    }
+
+    // Chrome trace events use microseconds
+    [[nodiscard]] double microseconds(uint64_t const nanoseconds)
+    {
+        return static_cast<double>(nanoseconds) / 1000.0;
+    }
+} // namespace
+
+vkrndr::cpu_profiler::cpu_profiler(size_t const retained_frames)
+    : start_{std::chrono::steady_clock::now()}
+    , retained_frames_{retained_frames}
+{
+}
+
+uint64_t vkrndr::cpu_profiler::now() const noexcept
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_)
+            .count());
+}
+
+void vkrndr::cpu_profiler::record(char const* const name,
+    uint64_t const begin,
+    uint32_t const depth)
+{
+    uint64_t const end{now()};
+
+    thread_buffer* const buffer{current_thread_buffer()};
+    size_t const head{buffer->head.load(std::memory_order_relaxed)};
+    if (head - buffer->tail.load(std::memory_order_acquire) ==
+        zones_per_thread)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer->zones[head % zones_per_thread] = {.name = name,
+        .begin = begin,
+        .end = end,
+        .thread = buffer->thread,
+        .depth = depth};
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void vkrndr::cpu_profiler::end_frame()
+{
+    cpu_frame frame{.begin = frame_begin_, .end = now(), .zones = {}};
+
+    {
+        std::lock_guard const lock{buffers_mutex_};
+        for (auto const& buffer : buffers_)
+        {
+            size_t tail{buffer->tail.load(std::memory_order_relaxed)};
+            size_t const head{buffer->head.load(std::memory_order_acquire)};
+            for (; tail != head; ++tail)
+            {
+                frame.zones.push_back(buffer->zones[tail % zones_per_thread]);
+            }
+            buffer->tail.store(tail, std::memory_order_release);
+        }
+    }
+
+    // Zones end in order on each thread, outer zones end after inner ones
+    std::ranges::sort(frame.zones,
+        [](cpu_zone const& lhs, cpu_zone const& rhs)
+        {
+            return std::tie(lhs.thread, lhs.begin, lhs.depth) <
+                std::tie(rhs.thread, rhs.begin, rhs.depth);
+        });
+
+    frame_begin_ = frame.end;
+    frames_.push_back(std::move(frame));
+    while (frames_.size() > retained_frames_)
+    {
+        frames_.pop_front();
+    }
+}
+
+uint64_t vkrndr::cpu_profiler::dropped_zones() const noexcept
+{
+    std::lock_guard const lock{buffers_mutex_};
+
+    uint64_t rv{};
+    for (auto const& buffer : buffers_)
+    {
+        rv += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return rv;
+}
+
+void vkrndr::cpu_profiler::write_chrome_trace(std::ostream& stream) const
+{
+    auto out{std::ostreambuf_iterator<char>{stream}};
+
+    char const* separator{""};
+    auto const write_event = [&](char const* const name,
+                                 uint64_t const tid,
+                                 uint64_t const begin,
+                                 uint64_t const end)
+    {
+        out = fmt::format_to(out,
+            "{}\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},"
+            "\"ts\":{:.3f},\"dur\":{:.3f}}}",
+            separator,
+            json_escape(name),
+            tid,
+            microseconds(begin),
+            microseconds(end - begin));
+        separator = ",";
+    };
+
+    out = fmt::format_to(out, "{{\"traceEvents\":[");
+    for (cpu_frame const& frame : frames_)
+    {
+        write_event("frame", 0, frame.begin, frame.end);
+        for (cpu_zone const& zone : frame.zones)
+        {
+            write_event(zone.name,
+                uint64_t{zone.thread} + 1,
+                zone.begin,
+                zone.end);
+        }
+    }
+    out = fmt::format_to(out, "\n],\"displayTimeUnit\":\"ns\"}}\n");
+}
+
+vkrndr::cpu_profiler::thread_buffer*
+vkrndr::cpu_profiler::current_thread_buffer()
+{
+    thread_local cpu_profiler const* owner{};
+    thread_local thread_buffer* buffer{};
+    if (owner != this)
+    {
+        std::lock_guard const lock{buffers_mutex_};
+
+        auto& added{buffers_.emplace_back(std::make_unique<thread_buffer>())};
+        added->thread = static_cast<uint32_t>(buffers_.size() - 1);
+
+        owner = this;
+        buffer = added.get();
+    }
+    return buffer;
+}
+
+vkrndr::cpu_profiler& vkrndr::global_cpu_profiler()
+{
+    static cpu_profiler rv;
+    return rv;
+}
+
+vkrndr::profile_zone::profile_zone(char const* const name)
+    : name_{name}
+    , begin_{global_cpu_profiler().now()}
+    , depth_{open_zones++}
+{
+}
+
+vkrndr::profile_zone::~profile_zone()
+{
+    --open_zones;
+    global_cpu_profiler().record(name_, begin_, depth_);
+}
@@ -0,0 +1,71 @@
+#include <range_allocator.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+vkrndr::range_allocator::range_allocator(uint64_t const size)
+    : free_ranges_{free_range{.offset = 0, .size = size}}
+{
+}
+
+std::optional<uint64_t> vkrndr::range_allocator::allocate(uint64_t const size,
+    uint64_t const alignment)
+{
+    for (auto it{free_ranges_.begin()}; it != free_ranges_.end(); ++it)
+    {
+        uint64_t const aligned{
+            (it->offset + alignment - 1) / alignment * alignment};
+        uint64_t const end{it->offset + it->size};
+        if (aligned + size > end)
+        {
+            continue;
+        }
+
+        free_range const range{*it};
+        it = free_ranges_.erase(it);
+        if (aligned + size != end)
+        {
+            it = free_ranges_.insert(it,
+                free_range{.offset = aligned + size,
+                    .size = end - aligned - size});
+        }
+        if (aligned != range.offset)
+        {
+            free_ranges_.insert(it,
+                free_range{.offset = range.offset,
+                    .size = aligned - range.offset});
+        }
+
+        return aligned;
+    }
+
+    return std::nullopt;
+}
+
+void vkrndr::range_allocator::free(uint64_t const offset, uint64_t const size)
+{
+    auto next{std::ranges::upper_bound(free_ranges_,
+        offset,
+        {},
+        &free_range::offset)};
+    next = free_ranges_.insert(next,
+        free_range{.offset = offset, .size = size});
+
+    if (auto const following{std::next(next)};
+        following != free_ranges_.end() &&
+        next->offset + next->size == following->offset)
+    {
+        next->size += following->size;
+        free_ranges_.erase(following);
+    }
+
+    if (next != free_ranges_.begin())
+    {
+        if (auto const previous{std::prev(next)};
+            previous->offset + previous->size == next->offset)
+        {
+            previous->size += next->size;
+            free_ranges_.erase(next);
+        }
+    }
+}
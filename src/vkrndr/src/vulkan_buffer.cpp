@@ -0,0 +1,156 @@
+#include <vulkan_buffer.hpp>
+
+#include <vulkan_device.hpp>
+#include <vulkan_memory.hpp>
+#include <vulkan_utility.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    // Non coherent allocations start and end on an atom boundary
+    [[nodiscard]] VkMappedMemoryRange mapped_range(
+        vkrndr::vulkan_device const* const device,
+        vkrndr::vulkan_buffer const& buffer,
+        VkDeviceSize const offset,
+        VkDeviceSize const size)
+    {
+        auto const atom{device->non_coherent_atom_size()};
+        VkDeviceSize const begin{offset / atom * atom};
+        VkDeviceSize const end{
+            std::min((offset + size + atom - 1) / atom * atom,
+                buffer.allocation.size)};
+
+        VkMappedMemoryRange rv{};
+        rv.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        rv.memory = buffer.allocation.memory;
+        rv.offset = buffer.allocation.offset + begin;
+        rv.size = end - begin;
+        return rv;
+    }
+} // namespace
+
+vkrndr::vulkan_buffer vkrndr::create_buffer(vulkan_device* const device,
+    VkDeviceSize const size,
+    VkBufferUsageFlags const usage,
+    VkMemoryPropertyFlags const memory_properties,
+    std::span<uint32_t const> const queue_families)
+{
+    VkBufferCreateInfo buffer_info{};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = usage;
+    if (queue_families.size() > 1)
+    {
+        buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        buffer_info.queueFamilyIndexCount = count_cast(queue_families.size());
+        buffer_info.pQueueFamilyIndices = queue_families.data();
+    }
+    else
+    {
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
+
+    vulkan_buffer rv;
+    if (vkCreateBuffer(device->logical(), &buffer_info, nullptr, &rv.buffer) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error{"failed to create buffer!"};
+    }
+
+    VkMemoryRequirements memory_requirements{};
+    vkGetBufferMemoryRequirements(device->logical(),
+        rv.buffer,
+        &memory_requirements);
+
+    // Host cached memory is meant for reading back on the host, which is
+    // slow from device local memory
+    bool const prefer_device_local{
+        (memory_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0 &&
+        (memory_properties & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) == 0};
+    VkMemoryPropertyFlags const preferred{prefer_device_local
+            ? memory_properties | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+            : memory_properties};
+
+    try
+    {
+        rv.allocation = device->allocator()->allocate(memory_requirements,
+            memory_properties,
+            preferred,
+            true);
+    }
+    catch (...)
+    {
+        vkDestroyBuffer(device->logical(), rv.buffer, nullptr);
+        throw;
+    }
+
+    if (vkBindBufferMemory(device->logical(),
+            rv.buffer,
+            rv.allocation.memory,
+            rv.allocation.offset) != VK_SUCCESS)
+    {
+        destroy(device, &rv);
+        throw std::runtime_error{"failed to bind buffer memory!"};
+    }
+
+    return rv;
+}
+
+void vkrndr::destroy(vulkan_device* const device, vulkan_buffer* const buffer)
+{
+    if (buffer)
+    {
+        vkDestroyBuffer(device->logical(), buffer->buffer, nullptr);
+        device->allocator()->free(buffer->allocation);
+        *buffer = {};
+    }
+}
+
+void* vkrndr::map_memory(vulkan_buffer const& buffer)
+{
+    if (!buffer.allocation.mapped)
+    {
+        throw std::runtime_error{"buffer memory is not host visible!"};
+    }
+    return buffer.allocation.mapped;
+}
+
+void vkrndr::flush_memory(vulkan_device* const device,
+    vulkan_buffer const& buffer,
+    VkDeviceSize const size)
+{
+    flush_memory(device,
+        buffer,
+        0,
+        size == VK_WHOLE_SIZE ? buffer.allocation.size : size);
+}
+
+void vkrndr::flush_memory(vulkan_device* const device,
+    vulkan_buffer const& buffer,
+    VkDeviceSize const offset,
+    VkDeviceSize const size)
+{
+    if (buffer.allocation.properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+    {
+        return;
+    }
+
+    VkMappedMemoryRange const range{mapped_range(device, buffer, offset, size)};
+    vkFlushMappedMemoryRanges(device->logical(), 1, &range);
+}
+
+void vkrndr::invalidate_memory(vulkan_device* const device,
+    vulkan_buffer const& buffer,
+    VkDeviceSize const offset,
+    VkDeviceSize const size)
+{
+    if (buffer.allocation.properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+    {
+        return;
+    }
+
+    VkMappedMemoryRange const range{mapped_range(device, buffer, offset, size)};
+    vkInvalidateMappedMemoryRanges(device->logical(), 1, &range);
+}
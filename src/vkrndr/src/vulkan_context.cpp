@@ -194,7 +194,11 @@ vkrndr::vulkan_context vkrndr::create_context(
     create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     create_info.pApplicationInfo = &app_info;
 
-    std::vector<char const*> required_extensions{window->required_extensions()};
+    std::vector<char const*> required_extensions;
+    if (window)
+    {
+        required_extensions = window->required_extensions();
+    }
 
     bool has_debug_utils_extension{setup_validation_layers};
     VkDebugUtilsMessengerCreateInfoEXT debug_create_info;
@@ -239,7 +243,7 @@ vkrndr::vulkan_context vkrndr::create_context(
     }
 
     VkSurfaceKHR surface{};
-    if (!window->create_surface(instance, surface))
+    if (window && !window->create_surface(instance, surface))
     {
         if (debug_messenger)
         {
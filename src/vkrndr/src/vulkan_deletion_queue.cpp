@@ -0,0 +1,92 @@
+#include <vulkan_deletion_queue.hpp>
+
+#include <vulkan_device.hpp>
+#include <vulkan_pipeline.hpp>
+
+#include <utility>
+
+vkrndr::vulkan_deletion_queue::vulkan_deletion_queue(
+    vulkan_device* const device)
+    : device_{device}
+{
+}
+
+vkrndr::vulkan_deletion_queue::~vulkan_deletion_queue() { release_all(); }
+
+void vkrndr::vulkan_deletion_queue::frame_submitted(
+    uint64_t const frame) noexcept
+{
+    submitted_frame_ = frame;
+}
+
+void vkrndr::vulkan_deletion_queue::push(vulkan_buffer buffer)
+{
+    defer([device = device_, buffer]() mutable { destroy(device, &buffer); });
+}
+
+void vkrndr::vulkan_deletion_queue::push(VkImage const image,
+    memory_allocation const memory)
+{
+    defer(
+        [device = device_, image, memory]()
+        {
+            vkDestroyImage(device->logical(), image, nullptr);
+            device->allocator()->free(memory);
+        });
+}
+
+void vkrndr::vulkan_deletion_queue::push(VkImageView const view)
+{
+    defer([device = device_, view]()
+        { vkDestroyImageView(device->logical(), view, nullptr); });
+}
+
+void vkrndr::vulkan_deletion_queue::push(VkDescriptorPool const pool,
+    VkDescriptorSet const set)
+{
+    defer([device = device_, pool, set]()
+        { vkFreeDescriptorSets(device->logical(), pool, 1, &set); });
+}
+
+void vkrndr::vulkan_deletion_queue::push(VkDescriptorSetLayout const layout)
+{
+    defer([device = device_, layout]()
+        { vkDestroyDescriptorSetLayout(device->logical(), layout, nullptr); });
+}
+
+void vkrndr::vulkan_deletion_queue::push(
+    std::unique_ptr<vulkan_pipeline> pipeline)
+{
+    defer([pipeline = std::move(pipeline)]() mutable { pipeline.reset(); });
+}
+
+void vkrndr::vulkan_deletion_queue::release(uint64_t const completed_frame)
+{
+    // Frames of entries never decrease, the oldest ones are in front
+    while (!entries_.empty() && entries_.front().frame <= completed_frame)
+    {
+        entries_.front().destroy();
+        entries_.pop_front();
+    }
+}
+
+void vkrndr::vulkan_deletion_queue::release_all()
+{
+    for (entry& e : entries_)
+    {
+        e.destroy();
+    }
+    entries_.clear();
+}
+
+size_t vkrndr::vulkan_deletion_queue::size() const noexcept
+{
+    return entries_.size();
+}
+
+void vkrndr::vulkan_deletion_queue::defer(
+    std::move_only_function<void()> destroy)
+{
+    entries_.push_back(
+        {.frame = submitted_frame_, .destroy = std::move(destroy)});
+}
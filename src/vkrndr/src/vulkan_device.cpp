@@ -1,13 +1,17 @@
 #include <vulkan_device.hpp>
 
 #include <vulkan_context.hpp>
+#include <vulkan_memory.hpp>
+#include <vulkan_pipeline_cache.hpp>
 #include <vulkan_swap_chain.hpp>
 #include <vulkan_utility.hpp>
 
 #include <array>
+#include <memory>
 #include <optional>
 #include <ranges>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <string_view>
 #include <utility>
@@ -15,9 +19,17 @@
 
 namespace
 {
+    // The swap chain extension is last, it isn't needed without a surface
     constexpr std::array const device_extensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-        VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME};
+        VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+        VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+
+    [[nodiscard]] std::span<char const* const> required_extensions(
+        VkSurfaceKHR const surface)
+    {
+        std::span<char const* const> const rv{device_extensions};
+        return surface == VK_NULL_HANDLE ? rv.first(rv.size() - 1) : rv;
+    }
 
 #ifndef _MSC_VER
 #pragma GCC diagnostic push
@@ -25,8 +37,14 @@ namespace
 #endif // _MSC_VER
     constexpr VkPhysicalDeviceFeatures device_features{
         .sampleRateShading = VK_TRUE,
+        .multiDrawIndirect = VK_TRUE,
+        .drawIndirectFirstInstance = VK_TRUE,
         .samplerAnisotropy = VK_TRUE};
 
+    constexpr VkPhysicalDeviceVulkan12Features device_12_features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .timelineSemaphore = VK_TRUE};
+
     constexpr VkPhysicalDeviceVulkan13Features device_13_features{
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
         .synchronization2 = VK_TRUE,
@@ -39,6 +57,7 @@ namespace
     {
         std::optional<uint32_t> graphics_family;
         std::optional<uint32_t> present_family;
+        std::optional<uint32_t> transfer_family;
     };
 
     queue_family_indices find_queue_families(VkPhysicalDevice device,
@@ -56,21 +75,43 @@ namespace
 
         uint32_t i{};
         for (auto const& queue_family : queue_families)
+        {
+            // Families supporting only transfers are usually backed by
+            // dedicated copy engines, otherwise graphics queues are used
+            if ((queue_family.queueFlags &
+                    (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT |
+                        VK_QUEUE_TRANSFER_BIT)) == VK_QUEUE_TRANSFER_BIT)
+            {
+                indices.transfer_family = i;
+            }
+            i++;
+        }
+
+        i = 0;
+        for (auto const& queue_family : queue_families)
         {
             if (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
             {
                 indices.graphics_family = i;
             }
 
-            VkBool32 present_support{VK_FALSE};
-            vkGetPhysicalDeviceSurfaceSupportKHR(device,
-                i,
-                surface,
-                &present_support);
-
-            if (present_support)
+            if (surface == VK_NULL_HANDLE)
+            {
+                // Nothing is presented without a surface
+                indices.present_family = indices.graphics_family;
+            }
+            else
             {
-                indices.present_family = i;
+                VkBool32 present_support{VK_FALSE};
+                vkGetPhysicalDeviceSurfaceSupportKHR(device,
+                    i,
+                    surface,
+                    &present_support);
+
+                if (present_support)
+                {
+                    indices.present_family = i;
+                }
             }
 
             if (indices.graphics_family && indices.present_family)
@@ -84,7 +125,8 @@ namespace
         return indices;
     }
 
-    [[nodiscard]] bool extensions_supported(VkPhysicalDevice device)
+    [[nodiscard]] bool extensions_supported(VkPhysicalDevice device,
+        VkSurfaceKHR surface)
     {
         uint32_t count{};
         vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr);
@@ -95,22 +137,22 @@ namespace
             &count,
             available_extensions.data());
 
-        std::set<std::string_view> required_extensions(
-            device_extensions.cbegin(),
-            device_extensions.cend());
+        auto const required{required_extensions(surface)};
+        std::set<std::string_view> missing_extensions(required.begin(),
+            required.end());
         for (auto const& extension : available_extensions)
         {
-            required_extensions.erase(extension.extensionName);
+            missing_extensions.erase(extension.extensionName);
         }
 
-        return required_extensions.empty();
+        return missing_extensions.empty();
     }
 
     [[nodiscard]] bool is_device_suitable(VkPhysicalDevice device,
         VkSurfaceKHR surface,
         queue_family_indices& indices)
     {
-        if (!extensions_supported(device))
+        if (!extensions_supported(device, surface))
         {
             return false;
         }
@@ -123,18 +165,24 @@ namespace
             return false;
         }
 
-        auto swap_chain{vkrndr::query_swap_chain_support(device, surface)};
-        bool const swap_chain_adequate = {!swap_chain.surface_formats.empty() &&
-            !swap_chain.present_modes.empty()};
-        if (!swap_chain_adequate)
+        if (surface != VK_NULL_HANDLE)
         {
-            return false;
+            auto swap_chain{vkrndr::query_swap_chain_support(device, surface)};
+            bool const swap_chain_adequate = {
+                !swap_chain.surface_formats.empty() &&
+                !swap_chain.present_modes.empty()};
+            if (!swap_chain_adequate)
+            {
+                return false;
+            }
         }
 
         VkPhysicalDeviceFeatures supported_features{};
         vkGetPhysicalDeviceFeatures(device, &supported_features);
         bool const features_adequate{
-            supported_features.samplerAnisotropy == VK_TRUE};
+            supported_features.samplerAnisotropy == VK_TRUE &&
+            supported_features.multiDrawIndirect == VK_TRUE &&
+            supported_features.drawIndirectFirstInstance == VK_TRUE};
         if (!features_adequate)
         {
             return false;
@@ -168,17 +216,75 @@ namespace
         }
         return VK_SAMPLE_COUNT_1_BIT;
     }
+
+    // Named apart from the member accessor, which would hide it inside the
+    // constructor
+    [[nodiscard]] VkDeviceSize memory_atom_size(VkPhysicalDevice device)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device, &properties);
+        return properties.limits.nonCoherentAtomSize;
+    }
+
+    [[nodiscard]] VkDeviceSize storage_offset_alignment(
+        VkPhysicalDevice device)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device, &properties);
+        return properties.limits.minStorageBufferOffsetAlignment;
+    }
+
+    [[nodiscard]] float queue_timestamp_period(VkPhysicalDevice device,
+        uint32_t const graphics_family)
+    {
+        uint32_t count{};
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &count, nullptr);
+        std::vector<VkQueueFamilyProperties> families{count};
+        vkGetPhysicalDeviceQueueFamilyProperties(device,
+            &count,
+            families.data());
+        if (families[graphics_family].timestampValidBits == 0)
+        {
+            return 0.0f;
+        }
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device, &properties);
+        return properties.limits.timestampPeriod;
+    }
+
+    // Optional, enabled whenever the device supports it
+    [[nodiscard]] bool supports_pipeline_statistics(VkPhysicalDevice device)
+    {
+        VkPhysicalDeviceFeatures supported_features{};
+        vkGetPhysicalDeviceFeatures(device, &supported_features);
+        return supported_features.pipelineStatisticsQuery == VK_TRUE;
+    }
 } // namespace
 
 vkrndr::vulkan_device::vulkan_device(VkPhysicalDevice physical_device,
     VkDevice logical_device,
     uint32_t graphics_family,
-    uint32_t present_family)
+    uint32_t present_family,
+    uint32_t transfer_family,
+    std::optional<std::filesystem::path> pipeline_cache_directory)
     : physical_device_{physical_device}
     , logical_device_{logical_device}
     , graphics_family_{graphics_family}
     , present_family_{present_family}
+    , transfer_family_{transfer_family}
     , max_msaa_samples_{max_usable_sample_count(physical_device)}
+    , non_coherent_atom_size_{memory_atom_size(physical_device)}
+    , storage_buffer_alignment_{storage_offset_alignment(physical_device)}
+    , timestamp_period_{
+          queue_timestamp_period(physical_device, graphics_family)}
+    , pipeline_statistics_{supports_pipeline_statistics(physical_device)}
+    , allocator_{std::make_unique<vulkan_memory_allocator>(physical_device,
+          logical_device,
+          non_coherent_atom_size_)}
+    , pipeline_cache_{std::make_unique<vulkan_pipeline_cache>(physical_device,
+          logical_device,
+          pipeline_cache_directory)}
 {
 }
 
@@ -187,15 +293,35 @@ vkrndr::vulkan_device::vulkan_device(vulkan_device&& other) noexcept
     , logical_device_{std::exchange(other.logical_device_, nullptr)}
     , graphics_family_{other.graphics_family_}
     , present_family_{other.present_family_}
+    , transfer_family_{other.transfer_family_}
     , max_msaa_samples_{other.max_msaa_samples_}
+    , non_coherent_atom_size_{other.non_coherent_atom_size_}
+    , storage_buffer_alignment_{other.storage_buffer_alignment_}
+    , timestamp_period_{other.timestamp_period_}
+    , pipeline_statistics_{other.pipeline_statistics_}
+    , allocator_{std::move(other.allocator_)}
+    , pipeline_cache_{std::move(other.pipeline_cache_)}
 {
 }
 
 vkrndr::vulkan_device::~vulkan_device()
 {
+    allocator_.reset();
+    pipeline_cache_.reset();
     vkDestroyDevice(logical_device_, nullptr);
 }
 
+vkrndr::vulkan_memory_allocator*
+vkrndr::vulkan_device::allocator() const noexcept
+{
+    return allocator_.get();
+}
+
+VkPipelineCache vkrndr::vulkan_device::pipeline_cache() const noexcept
+{
+    return pipeline_cache_ ? pipeline_cache_->cache() : VK_NULL_HANDLE;
+}
+
 vkrndr::vulkan_device& vkrndr::vulkan_device::operator=(
     vulkan_device&& other) noexcept
 {
@@ -207,13 +333,21 @@ vkrndr::vulkan_device& vkrndr::vulkan_device::operator=(
         swap(logical_device_, other.logical_device_);
         swap(graphics_family_, other.graphics_family_);
         swap(present_family_, other.present_family_);
+        swap(transfer_family_, other.transfer_family_);
         swap(max_msaa_samples_, other.max_msaa_samples_);
+        swap(non_coherent_atom_size_, other.non_coherent_atom_size_);
+        swap(storage_buffer_alignment_, other.storage_buffer_alignment_);
+        swap(timestamp_period_, other.timestamp_period_);
+        swap(pipeline_statistics_, other.pipeline_statistics_);
+        swap(allocator_, other.allocator_);
+        swap(pipeline_cache_, other.pipeline_cache_);
     }
 
     return *this;
 }
 
-vkrndr::vulkan_device vkrndr::create_device(vulkan_context const& context)
+vkrndr::vulkan_device vkrndr::create_device(vulkan_context const& context,
+    std::optional<std::filesystem::path> pipeline_cache_directory)
 {
     uint32_t count{};
     vkEnumeratePhysicalDevices(context.instance(), &count, nullptr);
@@ -239,9 +373,13 @@ vkrndr::vulkan_device vkrndr::create_device(vulkan_context const& context)
 
     auto const graphics_family{device_indices.graphics_family.value_or(0)};
     auto const present_family{device_indices.present_family.value_or(0)};
+    auto const transfer_family{
+        device_indices.transfer_family.value_or(graphics_family)};
 
     float const priority{1.0f};
-    std::set<uint32_t> const unique_families{graphics_family, present_family};
+    std::set<uint32_t> const unique_families{graphics_family,
+        present_family,
+        transfer_family};
     std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
     for (uint32_t const family : unique_families)
     {
@@ -259,10 +397,18 @@ vkrndr::vulkan_device vkrndr::create_device(vulkan_context const& context)
     create_info.queueCreateInfoCount = count_cast(queue_create_infos.size());
     create_info.pQueueCreateInfos = queue_create_infos.data();
     create_info.enabledLayerCount = 0;
-    create_info.enabledExtensionCount = count_cast(device_extensions.size());
-    create_info.ppEnabledExtensionNames = device_extensions.data();
-    create_info.pEnabledFeatures = &device_features;
-    create_info.pNext = &device_13_features;
+    auto const extensions{required_extensions(context.surface())};
+    create_info.enabledExtensionCount = count_cast(extensions.size());
+    create_info.ppEnabledExtensionNames = extensions.data();
+    VkPhysicalDeviceFeatures features{device_features};
+    features.pipelineStatisticsQuery =
+        supports_pipeline_statistics(*device_it) ? VK_TRUE : VK_FALSE;
+    create_info.pEnabledFeatures = &features;
+
+    VkPhysicalDeviceVulkan12Features features_12{device_12_features};
+    VkPhysicalDeviceVulkan13Features features_13{device_13_features};
+    features_13.pNext = &features_12;
+    create_info.pNext = &features_13;
 
     VkDevice logical_device{};
     if (vkCreateDevice(*device_it, &create_info, nullptr, &logical_device) !=
@@ -271,5 +417,10 @@ vkrndr::vulkan_device vkrndr::create_device(vulkan_context const& context)
         throw std::runtime_error{"failed to create logical device!"};
     }
 
-    return {*device_it, logical_device, graphics_family, present_family};
+    return {*device_it,
+        logical_device,
+        graphics_family,
+        present_family,
+        transfer_family,
+        std::move(pipeline_cache_directory)};
 }
@@ -0,0 +1,331 @@
+#include <vulkan_gpu_profiler.hpp>
+
+#include <vulkan_device.hpp>
+#include <vulkan_utility.hpp>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    // Timestamp queries of a frame, each target has a begin and an end
+    // query following first_target_query
+    constexpr uint32_t frame_begin_query{0};
+    constexpr uint32_t rendering_end_query{1};
+    constexpr uint32_t frame_end_query{2};
+    constexpr uint32_t imgui_begin_query{3};
+    constexpr uint32_t imgui_end_query{4};
+    constexpr uint32_t first_target_query{5};
+
+    constexpr uint32_t targets_statistics_query{0};
+    constexpr uint32_t imgui_statistics_query{1};
+    constexpr uint32_t statistics_query_count{2};
+
+    // Results are written in the order of the bits
+    constexpr VkQueryPipelineStatisticFlags pipeline_statistics{
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT};
+
+    [[nodiscard]] constexpr uint32_t timestamp_query_count(
+        uint32_t const targets)
+    {
+        return first_target_query + 2 * targets;
+    }
+
+    [[nodiscard]] VkQueryPool create_query_pool(
+        vkrndr::vulkan_device const* const device,
+        VkQueryType const type,
+        uint32_t const count,
+        VkQueryPipelineStatisticFlags const statistics = 0)
+    {
+        VkQueryPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        pool_info.queryType = type;
+        pool_info.queryCount = count;
+        pool_info.pipelineStatistics = statistics;
+
+        VkQueryPool rv{};
+        if (vkCreateQueryPool(device->logical(), &pool_info, nullptr, &rv) !=
+            VK_SUCCESS)
+        {
+            throw std::runtime_error{"failed to create query pool"};
+        }
+
+        return rv;
+    }
+
+    [[nodiscard]] std::optional<vkrndr::gpu_pipeline_statistics>
+    read_statistics(vkrndr::vulkan_device const* const device,
+        VkQueryPool const pool,
+        uint32_t const query)
+    {
+        std::array<uint64_t, 4> values{};
+        if (vkGetQueryPoolResults(device->logical(),
+                pool,
+                query,
+                1,
+                sizeof(values),
+                values.data(),
+                sizeof(values),
+                VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        {
+            return std::nullopt;
+        }
+
+        return vkrndr::gpu_pipeline_statistics{.input_vertices = values[0],
+            .vertex_invocations = values[1],
+            .clipping_primitives = values[2],
+            .fragment_invocations = values[3]};
+    }
+} // namespace
+
+vkrndr::vulkan_gpu_profiler::vulkan_gpu_profiler(vulkan_device* const device,
+    uint32_t const frames_in_flight,
+    uint32_t const max_targets)
+    : device_{device}
+    , max_targets_{max_targets}
+    , frames_(frames_in_flight)
+{
+    if (!enabled())
+    {
+        return;
+    }
+
+    for (frame_data& frame : frames_)
+    {
+        frame.timestamps = create_query_pool(device_,
+            VK_QUERY_TYPE_TIMESTAMP,
+            timestamp_query_count(max_targets_));
+
+        if (device_->has_pipeline_statistics())
+        {
+            frame.statistics = create_query_pool(device_,
+                VK_QUERY_TYPE_PIPELINE_STATISTICS,
+                statistics_query_count,
+                pipeline_statistics);
+        }
+    }
+}
+
+vkrndr::vulkan_gpu_profiler::~vulkan_gpu_profiler()
+{
+    for (frame_data& frame : frames_)
+    {
+        vkDestroyQueryPool(device_->logical(), frame.statistics, nullptr);
+        vkDestroyQueryPool(device_->logical(), frame.timestamps, nullptr);
+    }
+}
+
+bool vkrndr::vulkan_gpu_profiler::enabled() const noexcept
+{
+    return device_->timestamp_period() > 0.0f;
+}
+
+void vkrndr::vulkan_gpu_profiler::collect(uint32_t const frame_index)
+{
+    frame_data& data{frames_[frame_index]};
+    if (!data.target_count)
+    {
+        return;
+    }
+
+    uint32_t const targets{std::min(*data.target_count, max_targets_)};
+    std::vector<uint64_t> values(timestamp_query_count(targets));
+    if (vkGetQueryPoolResults(device_->logical(),
+            data.timestamps,
+            0,
+            count_cast(values.size()),
+            values.size() * sizeof(uint64_t),
+            values.data(),
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+    {
+        return;
+    }
+
+    gpu_frame_timings rv;
+    rv.frame = data.frame;
+    rv.frame_ms =
+        milliseconds(values[frame_begin_query], values[frame_end_query]);
+    rv.imgui_ms =
+        milliseconds(values[imgui_begin_query], values[imgui_end_query]);
+    rv.resolve_ms =
+        milliseconds(values[imgui_end_query], values[rendering_end_query]);
+    for (uint32_t i{}; i != targets; ++i)
+    {
+        uint32_t const query{first_target_query + 2 * i};
+        rv.target_ms.push_back(milliseconds(values[query], values[query + 1]));
+    }
+
+    if (data.statistics)
+    {
+        if (*data.target_count != 0)
+        {
+            rv.target_statistics = read_statistics(device_,
+                data.statistics,
+                targets_statistics_query);
+        }
+        rv.imgui_statistics =
+            read_statistics(device_, data.statistics, imgui_statistics_query);
+    }
+
+    latest_ = std::move(rv);
+    data.target_count.reset();
+}
+
+void vkrndr::vulkan_gpu_profiler::begin_frame(
+    VkCommandBuffer const command_buffer,
+    uint32_t const frame_index)
+{
+    if (!enabled())
+    {
+        return;
+    }
+
+    frame_data& data{frames_[frame_index]};
+    data.target_count.reset();
+    data.frame = ++recorded_frames_;
+
+    vkCmdResetQueryPool(command_buffer,
+        data.timestamps,
+        0,
+        timestamp_query_count(max_targets_));
+    if (data.statistics)
+    {
+        vkCmdResetQueryPool(command_buffer,
+            data.statistics,
+            0,
+            statistics_query_count);
+    }
+
+    write_timestamp(command_buffer,
+        frame_index,
+        VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+        frame_begin_query);
+}
+
+void vkrndr::vulkan_gpu_profiler::end_frame(
+    VkCommandBuffer const command_buffer,
+    uint32_t const frame_index,
+    uint32_t const target_count)
+{
+    if (!enabled())
+    {
+        return;
+    }
+
+    write_timestamp(command_buffer,
+        frame_index,
+        VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        frame_end_query);
+    frames_[frame_index].target_count = target_count;
+}
+
+void vkrndr::vulkan_gpu_profiler::end_rendering(
+    VkCommandBuffer const command_buffer,
+    uint32_t const frame_index)
+{
+    write_timestamp(command_buffer,
+        frame_index,
+        VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        rendering_end_query);
+}
+
+void vkrndr::vulkan_gpu_profiler::begin_target(
+    VkCommandBuffer const command_buffer,
+    uint32_t const frame_index,
+    uint32_t const target)
+{
+    if (target < max_targets_)
+    {
+        write_timestamp(command_buffer,
+            frame_index,
+            VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+            first_target_query + 2 * target);
+    }
+}
+
+void vkrndr::vulkan_gpu_profiler::end_target(
+    VkCommandBuffer const command_buffer,
+    uint32_t const frame_index,
+    uint32_t const target)
+{
+    if (target < max_targets_)
+    {
+        write_timestamp(command_buffer,
+            frame_index,
+            VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            first_target_query + 2 * target + 1);
+    }
+}
+
+void vkrndr::vulkan_gpu_profiler::begin_targets(
+    VkCommandBuffer const command_buffer,
+    uint32_t const frame_index)
+{
+    if (VkQueryPool const pool{frames_[frame_index].statistics})
+    {
+        vkCmdBeginQuery(command_buffer, pool, targets_statistics_query, 0);
+    }
+}
+
+void vkrndr::vulkan_gpu_profiler::end_targets(
+    VkCommandBuffer const command_buffer,
+    uint32_t const frame_index)
+{
+    if (VkQueryPool const pool{frames_[frame_index].statistics})
+    {
+        vkCmdEndQuery(command_buffer, pool, targets_statistics_query);
+    }
+}
+
+void vkrndr::vulkan_gpu_profiler::begin_imgui(
+    VkCommandBuffer const command_buffer,
+    uint32_t const frame_index)
+{
+    write_timestamp(command_buffer,
+        frame_index,
+        VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+        imgui_begin_query);
+    if (VkQueryPool const pool{frames_[frame_index].statistics})
+    {
+        vkCmdBeginQuery(command_buffer, pool, imgui_statistics_query, 0);
+    }
+}
+
+void vkrndr::vulkan_gpu_profiler::end_imgui(
+    VkCommandBuffer const command_buffer,
+    uint32_t const frame_index)
+{
+    if (VkQueryPool const pool{frames_[frame_index].statistics})
+    {
+        vkCmdEndQuery(command_buffer, pool, imgui_statistics_query);
+    }
+    write_timestamp(command_buffer,
+        frame_index,
+        VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        imgui_end_query);
+}
+
+void vkrndr::vulkan_gpu_profiler::write_timestamp(
+    VkCommandBuffer const command_buffer,
+    uint32_t const frame_index,
+    VkPipelineStageFlags2 const stage,
+    uint32_t const query) const
+{
+    if (VkQueryPool const pool{frames_[frame_index].timestamps})
+    {
+        vkCmdWriteTimestamp2(command_buffer, stage, pool, query);
+    }
+}
+
+double vkrndr::vulkan_gpu_profiler::milliseconds(uint64_t const begin,
+    uint64_t const end) const noexcept
+{
+    return static_cast<double>(end - begin) *
+        static_cast<double>(device_->timestamp_period()) / 1e6;
+}
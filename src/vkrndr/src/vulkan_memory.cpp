@@ -0,0 +1,246 @@
+#include <vulkan_memory.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+namespace
+{
+    [[nodiscard]] constexpr VkDeviceSize align_up(VkDeviceSize const value,
+        VkDeviceSize const alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    [[nodiscard]] constexpr bool is_non_coherent(
+        VkMemoryPropertyFlags const properties)
+    {
+        return (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0 &&
+            (properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0;
+    }
+} // namespace
+
+vkrndr::vulkan_memory_allocator::vulkan_memory_allocator(
+    VkPhysicalDevice const physical_device,
+    VkDevice const logical_device,
+    VkDeviceSize const non_coherent_atom_size,
+    VkDeviceSize const block_size)
+    : physical_device_{physical_device}
+    , logical_device_{logical_device}
+    , non_coherent_atom_size_{non_coherent_atom_size}
+    , block_size_{align_up(block_size, non_coherent_atom_size)}
+{
+    vkGetPhysicalDeviceMemoryProperties(physical_device_, &memory_properties_);
+}
+
+vkrndr::vulkan_memory_allocator::~vulkan_memory_allocator()
+{
+    for (auto const& block : blocks_)
+    {
+        vkFreeMemory(logical_device_, block->memory, nullptr);
+    }
+}
+
+vkrndr::memory_allocation vkrndr::vulkan_memory_allocator::allocate(
+    VkMemoryRequirements const& requirements,
+    VkMemoryPropertyFlags const required,
+    VkMemoryPropertyFlags const preferred,
+    bool const linear)
+{
+    std::scoped_lock const lock{mutex_};
+
+    uint32_t const memory_type{select_memory_type(
+        requirements.memoryTypeBits,
+        required,
+        preferred)};
+    VkMemoryPropertyFlags const properties{
+        memory_properties_.memoryTypes[memory_type].propertyFlags};
+
+    // Non coherent ranges are padded to whole atoms so flushing one never
+    // has to touch memory outside of it
+    VkDeviceSize size{requirements.size};
+    VkDeviceSize alignment{requirements.alignment};
+    if (is_non_coherent(properties))
+    {
+        size = align_up(size, non_coherent_atom_size_);
+        alignment = std::max(alignment, non_coherent_atom_size_);
+    }
+
+    memory_block* block{};
+    std::optional<VkDeviceSize> offset;
+    if (size > block_size_ / 2)
+    {
+        block = &allocate_block(memory_type, size, linear, true);
+        offset = block->ranges.allocate(size, alignment);
+    }
+    else
+    {
+        auto const it{std::ranges::find_if(blocks_,
+            [&](std::unique_ptr<memory_block> const& candidate)
+            {
+                if (candidate->memory_type != memory_type ||
+                    candidate->linear != linear || candidate->dedicated)
+                {
+                    return false;
+                }
+
+                offset = candidate->ranges.allocate(size, alignment);
+                return offset.has_value();
+            })};
+
+        if (it != blocks_.cend())
+        {
+            block = it->get();
+        }
+        else
+        {
+            block = &allocate_block(memory_type, block_size_, linear, false);
+            offset = block->ranges.allocate(size, alignment);
+        }
+    }
+
+    ++block->allocation_count;
+    block->used_bytes += size;
+
+    // Blocks are allocated large enough for the allocation, which always
+    // fits at the start of their memory
+    return {.memory = block->memory,
+        .offset = *offset,
+        .size = size,
+        .properties = properties,
+        .mapped = block->mapped ? block->mapped + *offset : nullptr};
+}
+
+void vkrndr::vulkan_memory_allocator::free(memory_allocation const& allocation)
+{
+    if (allocation.memory == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    std::scoped_lock const lock{mutex_};
+
+    auto const it{std::ranges::find(blocks_,
+        allocation.memory,
+        [](std::unique_ptr<memory_block> const& block)
+        { return block->memory; })};
+    if (it == blocks_.cend())
+    {
+        throw std::runtime_error{"freeing memory of unknown block"};
+    }
+
+    memory_block& block{**it};
+    --block.allocation_count;
+    block.used_bytes -= allocation.size;
+
+    if (block.dedicated && block.allocation_count == 0)
+    {
+        free_block(block);
+        return;
+    }
+
+    block.ranges.free(allocation.offset, allocation.size);
+}
+
+vkrndr::memory_statistics vkrndr::vulkan_memory_allocator::statistics() const
+{
+    std::scoped_lock const lock{mutex_};
+
+    memory_statistics rv;
+    for (auto const& block : blocks_)
+    {
+        ++rv.block_count;
+        rv.allocation_count += block->allocation_count;
+        rv.reserved_bytes += block->size;
+        rv.used_bytes += block->used_bytes;
+    }
+    return rv;
+}
+
+uint32_t vkrndr::vulkan_memory_allocator::select_memory_type(
+    uint32_t const type_bits,
+    VkMemoryPropertyFlags const required,
+    VkMemoryPropertyFlags const preferred) const
+{
+    std::optional<uint32_t> rv;
+    for (uint32_t i{}; i != memory_properties_.memoryTypeCount; ++i)
+    {
+        VkMemoryPropertyFlags const flags{
+            memory_properties_.memoryTypes[i].propertyFlags};
+        if ((type_bits & (1u << i)) == 0 || (flags & required) != required)
+        {
+            continue;
+        }
+
+        if ((flags & preferred) == preferred)
+        {
+            return i;
+        }
+
+        if (!rv)
+        {
+            rv = i;
+        }
+    }
+
+    if (!rv)
+    {
+        throw std::runtime_error{"failed to find suitable memory type!"};
+    }
+
+    return *rv;
+}
+
+vkrndr::vulkan_memory_allocator::memory_block&
+vkrndr::vulkan_memory_allocator::allocate_block(uint32_t const memory_type,
+    VkDeviceSize const size,
+    bool const linear,
+    bool const dedicated)
+{
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = size;
+    alloc_info.memoryTypeIndex = memory_type;
+
+    auto block{std::make_unique<memory_block>()};
+    if (vkAllocateMemory(logical_device_,
+            &alloc_info,
+            nullptr,
+            &block->memory) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"failed to allocate memory block!"};
+    }
+
+    if (memory_properties_.memoryTypes[memory_type].propertyFlags &
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        void* mapped{};
+        if (vkMapMemory(logical_device_,
+                block->memory,
+                0,
+                VK_WHOLE_SIZE,
+                0,
+                &mapped) != VK_SUCCESS)
+        {
+            vkFreeMemory(logical_device_, block->memory, nullptr);
+            throw std::runtime_error{"failed to map memory block!"};
+        }
+        block->mapped = static_cast<std::byte*>(mapped);
+    }
+
+    block->size = size;
+    block->memory_type = memory_type;
+    block->linear = linear;
+    block->dedicated = dedicated;
+    block->ranges = range_allocator{size};
+
+    return *blocks_.emplace_back(std::move(block));
+}
+
+void vkrndr::vulkan_memory_allocator::free_block(memory_block const& block)
+{
+    vkFreeMemory(logical_device_, block.memory, nullptr);
+    std::erase_if(blocks_,
+        [&block](std::unique_ptr<memory_block> const& candidate)
+        { return candidate.get() == &block; });
+}
@@ -0,0 +1,511 @@
+#include <vulkan_offscreen_renderer.hpp>
+
+#include <vulkan_buffer.hpp>
+#include <vulkan_device.hpp>
+#include <vulkan_memory.hpp>
+#include <vulkan_render_target.hpp>
+#include <vulkan_utility.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+namespace
+{
+    constexpr VkDeviceSize staging_size{4 * 1024 * 1024};
+
+    // Images are VK_FORMAT_R8G8B8A8_UNORM
+    constexpr VkDeviceSize bytes_per_pixel{4};
+
+    [[nodiscard]] VkCommandPool create_command_pool(
+        vkrndr::vulkan_device const* const device)
+    {
+        VkCommandPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        pool_info.queueFamilyIndex = device->graphics_family();
+
+        VkCommandPool rv{};
+        if (vkCreateCommandPool(device->logical(), &pool_info, nullptr, &rv) !=
+            VK_SUCCESS)
+        {
+            throw std::runtime_error{"failed to create command pool"};
+        }
+
+        return rv;
+    }
+
+    [[nodiscard]] VkCommandBuffer allocate_command_buffer(
+        vkrndr::vulkan_device const* const device,
+        VkCommandPool const command_pool,
+        VkCommandBufferLevel const level)
+    {
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = command_pool;
+        alloc_info.level = level;
+        alloc_info.commandBufferCount = 1;
+
+        VkCommandBuffer rv{};
+        if (vkAllocateCommandBuffers(device->logical(), &alloc_info, &rv) !=
+            VK_SUCCESS)
+        {
+            throw std::runtime_error{"failed to allocate command buffers!"};
+        }
+
+        return rv;
+    }
+
+    [[nodiscard]] VkDescriptorPool create_descriptor_pool(
+        vkrndr::vulkan_device const* const device)
+    {
+        constexpr uint32_t max_target_sets{4};
+
+        // Targets keep a copy of their data for each frame in flight in one
+        // buffer, a single set selects the copy with a dynamic offset
+        VkDescriptorPoolSize dynamic_storage_buffer_pool_size{};
+        dynamic_storage_buffer_pool_size.type =
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        dynamic_storage_buffer_pool_size.descriptorCount = max_target_sets;
+
+        VkDescriptorPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        pool_info.poolSizeCount = 1;
+        pool_info.pPoolSizes = &dynamic_storage_buffer_pool_size;
+        pool_info.maxSets = max_target_sets;
+
+        VkDescriptorPool rv{};
+        if (vkCreateDescriptorPool(device->logical(),
+                &pool_info,
+                nullptr,
+                &rv) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"failed to create descriptor pool"};
+        }
+
+        return rv;
+    }
+
+    void image_barrier(VkCommandBuffer const command_buffer,
+        VkImage const image,
+        VkPipelineStageFlags2 const src_stage,
+        VkAccessFlags2 const src_access,
+        VkPipelineStageFlags2 const dst_stage,
+        VkAccessFlags2 const dst_access,
+        VkImageLayout const old_layout,
+        VkImageLayout const new_layout)
+    {
+        VkImageMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = src_stage;
+        barrier.srcAccessMask = src_access;
+        barrier.dstStageMask = dst_stage;
+        barrier.dstAccessMask = dst_access;
+        barrier.oldLayout = old_layout;
+        barrier.newLayout = new_layout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1};
+
+        VkDependencyInfo dependency{};
+        dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependency.imageMemoryBarrierCount = 1;
+        dependency.pImageMemoryBarriers = &barrier;
+
+        vkCmdPipelineBarrier2(command_buffer, &dependency);
+    }
+
+    // Makes the copy to the readback buffer visible to the host once the
+    // frame is signaled on the timeline
+    void host_read_barrier(VkCommandBuffer const command_buffer,
+        VkBuffer const buffer)
+    {
+        VkBufferMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = buffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+
+        VkDependencyInfo dependency{};
+        dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependency.bufferMemoryBarrierCount = 1;
+        dependency.pBufferMemoryBarriers = &barrier;
+
+        vkCmdPipelineBarrier2(command_buffer, &dependency);
+    }
+} // namespace
+
+vkrndr::vulkan_offscreen_renderer::vulkan_offscreen_renderer(
+    vulkan_device* const device,
+    VkExtent2D const extent,
+    uint32_t const frames_in_flight)
+    : device_{device}
+    , extent_{extent}
+    , command_pool_{create_command_pool(device)}
+    , descriptor_pool_{create_descriptor_pool(device)}
+    , uploader_{device, staging_size}
+    , deletion_queue_{device}
+    , timeline_{create_timeline_semaphore(device)}
+    , frames_(frames_in_flight)
+{
+    vkGetDeviceQueue(device_->logical(),
+        device_->graphics_family(),
+        0,
+        &queue_);
+
+    if (is_multisampled())
+    {
+        create_image(device_,
+            extent_,
+            1,
+            device_->max_msaa_samples(),
+            image_format(),
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            color_image_,
+            color_image_memory_);
+
+        color_image_view_ = create_image_view(device_->logical(),
+            color_image_,
+            image_format(),
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            1);
+    }
+
+    for (frame_data& frame : frames_)
+    {
+        create_image(device_,
+            extent_,
+            1,
+            VK_SAMPLE_COUNT_1_BIT,
+            image_format(),
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            frame.image,
+            frame.image_memory);
+
+        frame.image_view = create_image_view(device_->logical(),
+            frame.image,
+            image_format(),
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            1);
+
+        frame.readback = create_buffer(device_,
+            image_size(),
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+
+        frame.command_buffer = allocate_command_buffer(device_,
+            command_pool_,
+            VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        frame.target_command_buffer = allocate_command_buffer(device_,
+            command_pool_,
+            VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+    }
+}
+
+vkrndr::vulkan_offscreen_renderer::~vulkan_offscreen_renderer()
+{
+    wait_semaphore(device_, timeline_, next_frame_);
+    vkDestroySemaphore(device_->logical(), timeline_, nullptr);
+
+    // Descriptor sets in the queue belong to the pool
+    deletion_queue_.release_all();
+
+    for (frame_data& frame : frames_)
+    {
+        destroy(device_, &frame.readback);
+        vkDestroyImageView(device_->logical(), frame.image_view, nullptr);
+        vkDestroyImage(device_->logical(), frame.image, nullptr);
+        device_->allocator()->free(frame.image_memory);
+    }
+
+    vkDestroyImageView(device_->logical(), color_image_view_, nullptr);
+    vkDestroyImage(device_->logical(), color_image_, nullptr);
+    device_->allocator()->free(color_image_memory_);
+
+    vkDestroyDescriptorPool(device_->logical(), descriptor_pool_, nullptr);
+
+    vkDestroyCommandPool(device_->logical(), command_pool_, nullptr);
+}
+
+uint32_t vkrndr::vulkan_offscreen_renderer::frames_in_flight() const noexcept
+{
+    return count_cast(frames_.size());
+}
+
+uint64_t vkrndr::vulkan_offscreen_renderer::draw(
+    std::span<vulkan_render_target const*> targets)
+{
+    uint64_t const index{next_frame_++};
+    auto const frame_index{static_cast<uint32_t>(index % frames_.size())};
+    frame_data& frame{frames_[frame_index]};
+
+    if (frame.index)
+    {
+        wait_semaphore(device_, timeline_, *frame.index + 1);
+    }
+    frame.index = index;
+
+    deletion_queue_.release(semaphore_value(device_, timeline_));
+
+    std::ranges::for_each(targets,
+        [frame_index](auto&& o) { o->update(frame_index); });
+
+    record_target_commands(frame, frame_index, targets);
+
+    record_command_buffer(frame, !targets.empty());
+
+    // Frames may use anything uploaded before they were recorded
+    uint64_t const uploaded{uploader_.submit()};
+
+    VkSemaphoreSubmitInfo wait_info{};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    wait_info.semaphore = uploader_.semaphore();
+    wait_info.value = uploaded;
+    wait_info.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkSemaphoreSubmitInfo signal_info{};
+    signal_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    signal_info.semaphore = timeline_;
+    signal_info.value = index + 1;
+    signal_info.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkCommandBufferSubmitInfo command_buffer_info{};
+    command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    command_buffer_info.commandBuffer = frame.command_buffer;
+
+    VkSubmitInfo2 submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submit_info.waitSemaphoreInfoCount = 1;
+    submit_info.pWaitSemaphoreInfos = &wait_info;
+    submit_info.commandBufferInfoCount = 1;
+    submit_info.pCommandBufferInfos = &command_buffer_info;
+    submit_info.signalSemaphoreInfoCount = 1;
+    submit_info.pSignalSemaphoreInfos = &signal_info;
+
+    if (vkQueueSubmit2(queue_, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"failed to submit draw command buffer!"};
+    }
+    deletion_queue_.frame_submitted(index + 1);
+
+    return index;
+}
+
+bool vkrndr::vulkan_offscreen_renderer::is_ready(uint64_t const frame) const
+{
+    // Throws for frames which were already overwritten
+    static_cast<void>(rendered_frame(frame));
+    return semaphore_value(device_, timeline_) > frame;
+}
+
+vkrndr::offscreen_frame vkrndr::vulkan_offscreen_renderer::read(
+    uint64_t const frame) const
+{
+    frame_data const& data{rendered_frame(frame)};
+
+    wait_semaphore(device_, timeline_, frame + 1);
+
+    invalidate_memory(device_, data.readback, 0, image_size());
+
+    return {.index = frame,
+        .extent = extent_,
+        .pixels = {static_cast<std::byte const*>(map_memory(data.readback)),
+            image_size()}};
+}
+
+vkrndr::vulkan_offscreen_renderer::frame_data const&
+vkrndr::vulkan_offscreen_renderer::rendered_frame(uint64_t const frame) const
+{
+    frame_data const& rv{frames_[frame % frames_.size()]};
+    if (rv.index != frame)
+    {
+        throw std::runtime_error{"frame is not available for readback"};
+    }
+    return rv;
+}
+
+void vkrndr::vulkan_offscreen_renderer::record_target_commands(
+    frame_data& frame,
+    uint32_t const frame_index,
+    std::span<vulkan_render_target const*> targets)
+{
+    if (is_recording_current(frame.recorded_targets, targets))
+    {
+        return;
+    }
+
+    VkFormat const format{image_format()};
+
+    VkCommandBufferInheritanceRenderingInfo rendering_info{};
+    rendering_info.sType =
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    rendering_info.colorAttachmentCount = 1;
+    rendering_info.pColorAttachmentFormats = &format;
+    rendering_info.rasterizationSamples = device_->max_msaa_samples();
+
+    VkCommandBufferInheritanceInfo inheritance_info{};
+    inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance_info.pNext = &rendering_info;
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    begin_info.pInheritanceInfo = &inheritance_info;
+    if (vkBeginCommandBuffer(frame.target_command_buffer, &begin_info) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error{"unable to begin command buffer recording!"};
+    }
+
+    std::ranges::for_each(targets,
+        [&, this](auto&& o)
+        { o->render(frame.target_command_buffer, extent_, frame_index); });
+
+    if (vkEndCommandBuffer(frame.target_command_buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"unable to end command buffer recording!"};
+    }
+
+    frame.recorded_targets.clear();
+    for (vulkan_render_target const* const target : targets)
+    {
+        frame.recorded_targets.push_back({target, target->generation()});
+    }
+}
+
+void vkrndr::vulkan_offscreen_renderer::record_command_buffer(
+    frame_data const& frame,
+    bool const has_targets)
+{
+    VkCommandBuffer const command_buffer{frame.command_buffer};
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"unable to begin command buffer recording!"};
+    }
+
+    // Previous contents are cleared, earlier copies from the image finished
+    // before the previous frame using it was signaled on the timeline
+    image_barrier(command_buffer,
+        frame.image,
+        VK_PIPELINE_STAGE_2_NONE,
+        VK_ACCESS_2_NONE,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+    constexpr VkClearValue clear_value{{{0.0f, 0.0f, 0.0f, 1.0f}}};
+    VkRenderingAttachmentInfo color_attachment_info{};
+    color_attachment_info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    color_attachment_info.imageLayout =
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color_attachment_info.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    color_attachment_info.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color_attachment_info.clearValue = clear_value;
+    if (is_multisampled())
+    {
+        // Shared by all frames, writes of the previous frame have to finish
+        image_barrier(command_buffer,
+            color_image_,
+            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+        color_attachment_info.imageView = color_image_view_;
+        color_attachment_info.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        color_attachment_info.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+        color_attachment_info.resolveImageView = frame.image_view;
+        color_attachment_info.resolveImageLayout =
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+    else
+    {
+        color_attachment_info.imageView = frame.image_view;
+    }
+
+    VkRenderingInfo render_info{};
+    render_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    render_info.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+    render_info.renderArea = {{0, 0}, extent_};
+    render_info.layerCount = 1;
+    render_info.colorAttachmentCount = 1;
+    render_info.pColorAttachments = &color_attachment_info;
+
+    vkCmdBeginRendering(command_buffer, &render_info);
+    if (has_targets)
+    {
+        vkCmdExecuteCommands(command_buffer, 1, &frame.target_command_buffer);
+    }
+    vkCmdEndRendering(command_buffer);
+
+    image_barrier(command_buffer,
+        frame.image,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_COPY_BIT,
+        VK_ACCESS_2_TRANSFER_READ_BIT,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .mipLevel = 0,
+        .baseArrayLayer = 0,
+        .layerCount = 1};
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {extent_.width, extent_.height, 1};
+    vkCmdCopyImageToBuffer(command_buffer,
+        frame.image,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        frame.readback.buffer,
+        1,
+        &region);
+
+    host_read_barrier(command_buffer, frame.readback.buffer);
+
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"unable to end command buffer recording!"};
+    }
+}
+
+bool vkrndr::vulkan_offscreen_renderer::is_multisampled() const
+{
+    return device_->max_msaa_samples() != VK_SAMPLE_COUNT_1_BIT;
+}
+
+VkDeviceSize vkrndr::vulkan_offscreen_renderer::image_size() const
+{
+    return VkDeviceSize{extent_.width} * extent_.height * bytes_per_pixel;
+}
@@ -16,7 +16,8 @@
 
 namespace
 {
-    [[nodiscard]] std::vector<char> read_file(std::filesystem::path const& file)
+    [[nodiscard]] std::vector<uint32_t> read_spirv(
+        std::filesystem::path const& file)
     {
         std::ifstream stream{file, std::ios::ate | std::ios::binary};
 
@@ -26,11 +27,17 @@ namespace
         }
 
         auto const eof{stream.tellg()};
+        auto const size{static_cast<size_t>(eof)};
+        if (size % sizeof(uint32_t) != 0)
+        {
+            throw std::runtime_error{"SPIR-V size isn't a multiple of words"};
+        }
 
-        std::vector<char> buffer(static_cast<size_t>(eof));
+        std::vector<uint32_t> buffer(size / sizeof(uint32_t));
         stream.seekg(0);
 
-        stream.read(buffer.data(), eof);
+        // NOLINTNEXTLINE
+        stream.read(reinterpret_cast<char*>(buffer.data()), eof);
 
         return buffer;
     }
@@ -39,12 +46,12 @@ namespace
 namespace
 {
     [[nodiscard]] VkShaderModule create_shader_module(VkDevice device,
-        std::span<char const> code)
+        std::span<uint32_t const> code)
     {
         VkShaderModuleCreateInfo create_info{};
         create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        create_info.codeSize = code.size();
-        create_info.pCode = reinterpret_cast<uint32_t const*>(code.data());
+        create_info.codeSize = code.size_bytes();
+        create_info.pCode = code.data();
 
         // TODO-JK: maintenance5 feature
         VkShaderModule module{};
@@ -110,16 +117,42 @@ vkrndr::vulkan_pipeline_builder::~vulkan_pipeline_builder() { cleanup(); }
 
 vkrndr::vulkan_pipeline vkrndr::vulkan_pipeline_builder::build()
 {
+    // Sized up front, shader stages point into them
+    std::vector<std::vector<VkSpecializationMapEntry>> map_entries(
+        shaders_.size());
+    std::vector<VkSpecializationInfo> specialization_infos(shaders_.size());
+
     std::vector<VkPipelineShaderStageCreateInfo> shader_stages;
     shader_stages.reserve(shaders_.size());
-    for (auto const& shader : shaders_)
+    for (size_t i{}; i != shaders_.size(); ++i)
     {
+        auto const& shader{shaders_[i]};
+
         VkPipelineShaderStageCreateInfo create_info{};
         create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         create_info.stage = std::get<0>(shader);
         create_info.module = std::get<1>(shader);
         create_info.pName = std::get<2>(shader).c_str();
 
+        for (auto const& constant : specialization_constants_)
+        {
+            if ((constant.stages & create_info.stage) != 0)
+            {
+                map_entries[i].push_back(constant.entry);
+            }
+        }
+
+        if (!map_entries[i].empty())
+        {
+            VkSpecializationInfo& info{specialization_infos[i]};
+            info.mapEntryCount = count_cast(map_entries[i].size());
+            info.pMapEntries = map_entries[i].data();
+            info.dataSize = specialization_data_.size();
+            info.pData = specialization_data_.data();
+
+            create_info.pSpecializationInfo = &info;
+        }
+
         shader_stages.push_back(create_info);
     }
 
@@ -229,7 +262,7 @@ vkrndr::vulkan_pipeline vkrndr::vulkan_pipeline_builder::build()
 
     VkPipeline pipeline{};
     if (vkCreateGraphicsPipelines(device_->logical(),
-            VK_NULL_HANDLE,
+            device_->pipeline_cache(),
             1,
             &create_info,
             nullptr,
@@ -247,13 +280,21 @@ vkrndr::vulkan_pipeline vkrndr::vulkan_pipeline_builder::build()
 vkrndr::vulkan_pipeline_builder& vkrndr::vulkan_pipeline_builder::add_shader(
     VkShaderStageFlagBits const stage,
     std::filesystem::path const& path,
-    std::string_view entry_point)
+    std::string_view const entry_point)
+{
+    return add_shader(stage, read_spirv(path), entry_point);
+}
+
+vkrndr::vulkan_pipeline_builder& vkrndr::vulkan_pipeline_builder::add_shader(
+    VkShaderStageFlagBits const stage,
+    std::span<uint32_t const> const code,
+    std::string_view const entry_point)
 {
     std::string name{entry_point};
     shaders_.reserve(shaders_.size() + 1);
 
     shaders_.emplace_back(stage,
-        create_shader_module(device_->logical(), read_file(path)),
+        create_shader_module(device_->logical(), code),
         std::move(name));
     return *this;
 }
@@ -302,8 +343,27 @@ vkrndr::vulkan_pipeline_builder::with_push_constants(
     return *this;
 }
 
+vkrndr::vulkan_pipeline_builder&
+vkrndr::vulkan_pipeline_builder::add_specialization_constant(
+    VkShaderStageFlags const stages,
+    uint32_t const constant_id,
+    std::span<std::byte const> const value)
+{
+    specialization_constants_.push_back({.stages = stages,
+        .entry = {.constantID = constant_id,
+            .offset = count_cast(specialization_data_.size()),
+            .size = value.size()}});
+    specialization_data_.insert(specialization_data_.cend(),
+        value.begin(),
+        value.end());
+
+    return *this;
+}
+
 void vkrndr::vulkan_pipeline_builder::cleanup()
 {
+    specialization_data_.clear();
+    specialization_constants_.clear();
     descriptor_set_layouts_.clear();
     vertex_input_attributes_.clear();
     vertex_input_binding_.clear();
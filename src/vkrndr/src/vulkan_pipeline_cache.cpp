@@ -0,0 +1,245 @@
+#include <vulkan_pipeline_cache.hpp>
+
+#include <fmt/format.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr std::array<char, 8> magic{'V', 'K', 'R', 'P', 'C', 'A', 'C', 'H'};
+    constexpr uint32_t format_version{1};
+
+    // Written in native byte order, the data is only valid for the machine
+    // which created it anyway
+    struct [[nodiscard]] file_header final
+    {
+        std::array<char, 8> magic{};
+        uint32_t format_version{};
+        uint32_t vendor_id{};
+        uint32_t device_id{};
+        uint32_t driver_version{};
+        std::array<uint8_t, VK_UUID_SIZE> cache_uuid{};
+        uint64_t data_size{};
+        uint64_t checksum{};
+    };
+
+    [[nodiscard]] uint64_t fnv1a(std::span<std::byte const> const data)
+    {
+        uint64_t rv{0xCBF29CE484222325};
+        for (std::byte const b : data)
+        {
+            rv ^= std::to_integer<uint64_t>(b);
+            rv *= 0x100000001B3;
+        }
+        return rv;
+    }
+
+    [[nodiscard]] file_header make_header(
+        VkPhysicalDeviceProperties const& properties,
+        std::span<std::byte const> const data)
+    {
+        file_header rv;
+        rv.magic = magic;
+        rv.format_version = format_version;
+        rv.vendor_id = properties.vendorID;
+        rv.device_id = properties.deviceID;
+        rv.driver_version = properties.driverVersion;
+        std::ranges::copy(properties.pipelineCacheUUID, rv.cache_uuid.begin());
+        rv.data_size = data.size();
+        rv.checksum = fnv1a(data);
+        return rv;
+    }
+
+    [[nodiscard]] bool matches(file_header const& header,
+        VkPhysicalDeviceProperties const& properties)
+    {
+        return header.magic == magic &&
+            header.format_version == format_version &&
+            header.vendor_id == properties.vendorID &&
+            header.device_id == properties.deviceID &&
+            header.driver_version == properties.driverVersion &&
+            std::ranges::equal(header.cache_uuid,
+                properties.pipelineCacheUUID);
+    }
+
+    // Returns the cache data stored in file, or nothing if the file doesn't
+    // exist or wasn't written for this device and driver
+    [[nodiscard]] std::vector<std::byte> load_cache_data(
+        std::filesystem::path const& file,
+        VkPhysicalDeviceProperties const& properties)
+    {
+        std::ifstream stream{file, std::ios::binary};
+        if (!stream)
+        {
+            return {};
+        }
+
+        file_header header;
+        // NOLINTNEXTLINE
+        if (!stream.read(reinterpret_cast<char*>(&header),
+                static_cast<std::streamsize>(sizeof(header))) ||
+            !matches(header, properties))
+        {
+            spdlog::info("Ignoring stale pipeline cache {}", file.string());
+            return {};
+        }
+
+        std::vector<std::byte> rv;
+        if (header.data_size < sizeof(VkPipelineCacheHeaderVersionOne) ||
+            header.data_size > 256 * 1024 * 1024)
+        {
+            spdlog::warn("Ignoring corrupted pipeline cache {}", file.string());
+            return {};
+        }
+        rv.resize(header.data_size);
+
+        // NOLINTNEXTLINE
+        if (!stream.read(reinterpret_cast<char*>(rv.data()),
+                static_cast<std::streamsize>(rv.size())) ||
+            fnv1a(rv) != header.checksum)
+        {
+            spdlog::warn("Ignoring corrupted pipeline cache {}", file.string());
+            return {};
+        }
+
+        // The driver validates its own header as well, but isn't required
+        // to handle data produced by someone else gracefully
+        VkPipelineCacheHeaderVersionOne cache_header;
+        memcpy(&cache_header, rv.data(), sizeof(cache_header));
+        if (cache_header.headerVersion !=
+                VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+            cache_header.vendorID != properties.vendorID ||
+            cache_header.deviceID != properties.deviceID ||
+            !std::ranges::equal(cache_header.pipelineCacheUUID,
+                properties.pipelineCacheUUID))
+        {
+            spdlog::warn("Ignoring corrupted pipeline cache {}", file.string());
+            return {};
+        }
+
+        return rv;
+    }
+
+    // Devices are told apart by their UUID, which stays the same across
+    // driver updates, so the driver version is part of the name as well
+    [[nodiscard]] std::filesystem::path cache_file_name(
+        VkPhysicalDevice const physical_device)
+    {
+        VkPhysicalDeviceIDProperties id_properties{};
+        id_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &id_properties;
+        vkGetPhysicalDeviceProperties2(physical_device, &properties);
+
+        std::string rv{"pipeline_cache_"};
+        for (uint8_t const b : id_properties.deviceUUID)
+        {
+            fmt::format_to(std::back_inserter(rv), "{:02x}", b);
+        }
+        fmt::format_to(std::back_inserter(rv),
+            "_{:08x}.bin",
+            properties.properties.driverVersion);
+        return rv;
+    }
+} // namespace
+
+vkrndr::vulkan_pipeline_cache::vulkan_pipeline_cache(
+    VkPhysicalDevice const physical_device,
+    VkDevice const logical_device,
+    std::optional<std::filesystem::path> const& directory)
+    : logical_device_{logical_device}
+{
+    vkGetPhysicalDeviceProperties(physical_device, &properties_);
+    if (directory)
+    {
+        file_ = *directory / cache_file_name(physical_device);
+    }
+
+    std::vector<std::byte> data;
+    if (file_)
+    {
+        data = load_cache_data(*file_, properties_);
+    }
+
+    VkPipelineCacheCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    create_info.initialDataSize = data.size();
+    create_info.pInitialData = data.data();
+
+    if (vkCreatePipelineCache(logical_device_,
+            &create_info,
+            nullptr,
+            &cache_) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"failed to create pipeline cache"};
+    }
+}
+
+vkrndr::vulkan_pipeline_cache::~vulkan_pipeline_cache()
+{
+    try
+    {
+        save();
+    }
+    catch (std::exception const& ex)
+    {
+        spdlog::warn("Unable to save pipeline cache: {}", ex.what());
+    }
+
+    vkDestroyPipelineCache(logical_device_, cache_, nullptr);
+}
+
+void vkrndr::vulkan_pipeline_cache::save() const
+{
+    if (!file_)
+    {
+        return;
+    }
+
+    size_t size{};
+    vkGetPipelineCacheData(logical_device_, cache_, &size, nullptr);
+
+    std::vector<std::byte> data(size);
+    if (vkGetPipelineCacheData(logical_device_, cache_, &size, data.data()) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error{"failed to retrieve pipeline cache data"};
+    }
+    data.resize(size);
+
+    file_header const header{make_header(properties_, data)};
+
+    // Written next to the destination and moved over it, so that an
+    // interrupted write never leaves a truncated cache behind
+    std::filesystem::path temporary{*file_};
+    temporary += ".tmp";
+    {
+        std::ofstream stream{temporary, std::ios::binary | std::ios::trunc};
+        // NOLINTNEXTLINE
+        stream.write(reinterpret_cast<char const*>(&header),
+            static_cast<std::streamsize>(sizeof(header)));
+        // NOLINTNEXTLINE
+        stream.write(reinterpret_cast<char const*>(data.data()),
+            static_cast<std::streamsize>(data.size()));
+        if (!stream.flush())
+        {
+            throw std::runtime_error{"failed to write pipeline cache"};
+        }
+    }
+
+    std::filesystem::rename(temporary, *file_);
+}
@@ -1,14 +1,32 @@
 #include <vulkan_render_target.hpp>
 
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+    std::atomic<uint64_t> next_generation{1};
+} // namespace
+
 void vkrndr::vulkan_render_target::attach_renderer(
     vulkan_device* const vulkan_device,
     VkDescriptorPool const descriptor_pool,
+    vulkan_uploader* const uploader,
+    vulkan_deletion_queue* const deletion_queue,
     VkFormat const image_format,
     uint32_t const frames_in_flight)
 {
     vulkan_device_ = vulkan_device;
     descriptor_pool_ = descriptor_pool;
+    uploader_ = uploader;
+    deletion_queue_ = deletion_queue;
     attach_renderer_impl(image_format, frames_in_flight);
+    invalidate_commands();
+}
+
+void vkrndr::vulkan_render_target::update(uint32_t const frame_index) const
+{
+    update_impl(frame_index);
 }
 
 void vkrndr::vulkan_render_target::render(VkCommandBuffer command_buffer,
@@ -23,4 +41,21 @@ void vkrndr::vulkan_render_target::detach_renderer()
     detach_renderer_impl();
     vulkan_device_ = nullptr;
     descriptor_pool_ = nullptr;
+    uploader_ = nullptr;
+    deletion_queue_ = nullptr;
+    invalidate_commands();
+}
+
+void vkrndr::vulkan_render_target::invalidate_commands() noexcept
+{
+    generation_ = next_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool vkrndr::is_recording_current(std::span<recorded_target const> recorded,
+    std::span<vulkan_render_target const* const> targets)
+{
+    return std::ranges::equal(recorded,
+        targets,
+        [](recorded_target const& lhs, vulkan_render_target const* rhs)
+        { return lhs.target == rhs && lhs.generation == rhs->generation(); });
 }
@@ -1,7 +1,9 @@
 #include <vulkan_renderer.hpp>
 
+#include <cpu_profiler.hpp>
 #include <vulkan_context.hpp>
 #include <vulkan_device.hpp>
+#include <vulkan_memory.hpp>
 #include <vulkan_render_target.hpp> // IWYU pragma: keep
 #include <vulkan_swap_chain.hpp>
 #include <vulkan_utility.hpp>
@@ -14,10 +16,16 @@
 #include <array>
 #include <cassert>
 #include <span>
+#include <vector>
 #include <stdexcept>
 
 namespace
 {
+    constexpr VkDeviceSize staging_size{4 * 1024 * 1024};
+
+    // Targets measured separately by the GPU profiler
+    constexpr uint32_t max_timed_targets{8};
+
     [[nodiscard]] VkCommandPool create_command_pool(
         vkrndr::vulkan_device const* const device)
     {
@@ -38,6 +46,7 @@ namespace
 
     void create_command_buffers(vkrndr::vulkan_device* const device,
         VkCommandPool const command_pool,
+        VkCommandBufferLevel const level,
         uint32_t const count,
         std::span<VkCommandBuffer> data_buffer)
     {
@@ -46,7 +55,7 @@ namespace
         VkCommandBufferAllocateInfo alloc_info{};
         alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         alloc_info.commandPool = command_pool;
-        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.level = level;
         alloc_info.commandBufferCount = count;
 
         if (vkAllocateCommandBuffers(device->logical(),
@@ -60,19 +69,21 @@ namespace
     VkDescriptorPool create_descriptor_pool(
         vkrndr::vulkan_device const* const device)
     {
-        constexpr auto count{vkrndr::count_cast(
-            vkrndr::vulkan_swap_chain::max_frames_in_flight)};
+        constexpr uint32_t max_target_sets{4};
 
-        VkDescriptorPoolSize uniform_buffer_pool_size{};
-        uniform_buffer_pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        uniform_buffer_pool_size.descriptorCount = 3 * count;
+        // Targets keep a copy of their data for each frame in flight in one
+        // buffer, a single set selects the copy with a dynamic offset
+        VkDescriptorPoolSize dynamic_storage_buffer_pool_size{};
+        dynamic_storage_buffer_pool_size.type =
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        dynamic_storage_buffer_pool_size.descriptorCount = max_target_sets;
 
         VkDescriptorPoolSize imgui_sampler_pool_size{};
         imgui_sampler_pool_size.type =
             VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         imgui_sampler_pool_size.descriptorCount = 1;
 
-        std::array pool_sizes{uniform_buffer_pool_size,
+        std::array pool_sizes{dynamic_storage_buffer_pool_size,
             imgui_sampler_pool_size};
 
         VkDescriptorPoolCreateInfo pool_info{};
@@ -80,7 +91,7 @@ namespace
         pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
         pool_info.poolSizeCount = vkrndr::count_cast(pool_sizes.size());
         pool_info.pPoolSizes = pool_sizes.data();
-        pool_info.maxSets = 3 * count + 1;
+        pool_info.maxSets = max_target_sets + 1;
 
         VkDescriptorPool rv{};
         if (vkCreateDescriptorPool(device->logical(),
@@ -120,6 +131,35 @@ namespace
 
         vkCmdPipelineBarrier2(command_buffer, &dependency);
     }
+
+    // Begins a secondary command buffer executed inside the dynamic
+    // rendering scope of the primary one
+    void begin_secondary_command_buffer(VkCommandBuffer const command_buffer,
+        VkFormat const image_format,
+        VkSampleCountFlagBits const samples)
+    {
+        VkCommandBufferInheritanceRenderingInfo rendering_info{};
+        rendering_info.sType =
+            VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+        rendering_info.colorAttachmentCount = 1;
+        rendering_info.pColorAttachmentFormats = &image_format;
+        rendering_info.rasterizationSamples = samples;
+
+        VkCommandBufferInheritanceInfo inheritance_info{};
+        inheritance_info.sType =
+            VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.pNext = &rendering_info;
+
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        begin_info.pInheritanceInfo = &inheritance_info;
+        if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
+        {
+            throw std::runtime_error{
+                "unable to begin command buffer recording!"};
+        }
+    }
 } // namespace
 
 vkrndr::vulkan_renderer::vulkan_renderer(vulkan_window* window,
@@ -131,21 +171,41 @@ vkrndr::vulkan_renderer::vulkan_renderer(vulkan_window* window,
     , device_{device}
     , swap_chain_{swap_chain}
     , command_pool_{create_command_pool(device)}
-    , command_buffers_{vulkan_swap_chain::max_frames_in_flight}
+    , command_buffers_(swap_chain->frames_in_flight())
+    , target_command_buffers_(swap_chain->frames_in_flight())
+    , imgui_command_buffers_(swap_chain->frames_in_flight())
+    , recorded_targets_(swap_chain->frames_in_flight())
     , descriptor_pool_{create_descriptor_pool(device)}
+    , uploader_{device, staging_size}
+    , deletion_queue_{device}
+    , gpu_profiler_{device, swap_chain->frames_in_flight(), max_timed_targets}
 {
     recreate();
 
     create_command_buffers(device_,
         command_pool_,
-        vulkan_swap_chain::max_frames_in_flight,
+        VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        frames_in_flight(),
         command_buffers_);
+    create_command_buffers(device_,
+        command_pool_,
+        VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+        frames_in_flight(),
+        target_command_buffers_);
+    create_command_buffers(device_,
+        command_pool_,
+        VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+        frames_in_flight(),
+        imgui_command_buffers_);
 
     init_imgui();
 }
 
 vkrndr::vulkan_renderer::~vulkan_renderer()
 {
+    // Descriptor sets in the queue belong to the pool
+    deletion_queue_.release_all();
+
     ImGui_ImplVulkan_Shutdown();
     window_->shutdown_imgui();
     ImGui::DestroyContext();
@@ -157,28 +217,65 @@ vkrndr::vulkan_renderer::~vulkan_renderer()
     cleanup_images();
 }
 
+uint32_t vkrndr::vulkan_renderer::frames_in_flight() const noexcept
+{
+    return swap_chain_->frames_in_flight();
+}
+
+bool vkrndr::vulkan_renderer::is_frame_available() const
+{
+    return swap_chain_->is_frame_available(current_frame_);
+}
+
 void vkrndr::vulkan_renderer::draw(
     std::span<vulkan_render_target const*> targets)
 {
     uint32_t image_index{};
-    if (!swap_chain_->acquire_next_image(current_frame_, image_index))
+    bool acquired{};
+    {
+        profile_zone const zone{"acquire"};
+        acquired = swap_chain_->acquire_next_image(current_frame_, image_index);
+    }
+    // The swap chain flagged itself for a refresh, which recreates it
+    // together with the renderer before the next frame
+    if (!acquired)
     {
-        recreate();
         return;
     }
 
+    // Acquiring the image waited for the previous use of this frame
+    deletion_queue_.release(swap_chain_->completed_frame());
+    gpu_profiler_.collect(current_frame_);
+
+    std::ranges::for_each(targets,
+        [this](auto&& o) { o->update(current_frame_); });
+
     auto& command_buffer{command_buffers_[current_frame_]};
 
-    vkResetCommandBuffer(command_buffer, 0);
+    {
+        profile_zone const zone{"record"};
 
-    record_command_buffer(targets, command_buffer, image_index);
+        vkResetCommandBuffer(command_buffer, 0);
 
-    swap_chain_->submit_command_buffer(&command_buffer,
-        current_frame_,
-        image_index);
+        record_command_buffer(targets, command_buffer, image_index);
+    }
+
+    // Frames may use anything uploaded before they were recorded
+    uint64_t const uploaded{uploader_.submit()};
 
-    current_frame_ =
-        (current_frame_ + 1) % vulkan_swap_chain::max_frames_in_flight;
+    {
+        // Submission includes presenting the image
+        profile_zone const zone{"present"};
+
+        deletion_queue_.frame_submitted(
+            swap_chain_->submit_command_buffer(&command_buffer,
+                current_frame_,
+                image_index,
+                uploader_.semaphore(),
+                uploaded));
+    }
+
+    current_frame_ = (current_frame_ + 1) % frames_in_flight();
 }
 
 void vkrndr::vulkan_renderer::init_imgui()
@@ -213,18 +310,79 @@ void vkrndr::vulkan_renderer::init_imgui()
     init_info.Device = device_->logical();
     init_info.QueueFamily = device_->graphics_family();
     init_info.Queue = swap_chain_->graphics_queue();
-    init_info.PipelineCache = VK_NULL_HANDLE;
+    init_info.PipelineCache = device_->pipeline_cache();
     init_info.DescriptorPool = descriptor_pool_;
     init_info.RenderPass = VK_NULL_HANDLE;
     init_info.Subpass = 0;
+    // ImGui reuses its geometry buffers ImageCount frames later, frames in
+    // flight are chosen independently of the number of images
     init_info.MinImageCount = swap_chain_->min_image_count();
-    init_info.ImageCount = swap_chain_->image_count();
+    init_info.ImageCount =
+        std::max(swap_chain_->image_count(), frames_in_flight());
     init_info.MSAASamples = device_->max_msaa_samples();
     init_info.Allocator = VK_NULL_HANDLE;
     init_info.CheckVkResultFn = nullptr;
     init_info.UseDynamicRendering = true;
     init_info.PipelineRenderingCreateInfo = rendering_create_info;
     ImGui_ImplVulkan_Init(&init_info);
+    imgui_min_image_count_ = init_info.MinImageCount;
+}
+
+void vkrndr::vulkan_renderer::record_target_commands(
+    std::span<vulkan_render_target const*> targets)
+{
+    auto& recorded{recorded_targets_[current_frame_]};
+    if (is_recording_current(recorded, targets))
+    {
+        return;
+    }
+
+    VkCommandBuffer const command_buffer{
+        target_command_buffers_[current_frame_]};
+    begin_secondary_command_buffer(command_buffer,
+        swap_chain_->image_format(),
+        device_->max_msaa_samples());
+
+    gpu_profiler_.begin_targets(command_buffer, current_frame_);
+    for (uint32_t i{}; i != targets.size(); ++i)
+    {
+        gpu_profiler_.begin_target(command_buffer, current_frame_, i);
+        targets[i]->render(command_buffer,
+            swap_chain_->extent(),
+            current_frame_);
+        gpu_profiler_.end_target(command_buffer, current_frame_, i);
+    }
+    gpu_profiler_.end_targets(command_buffer, current_frame_);
+
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"unable to end command buffer recording!"};
+    }
+
+    recorded.clear();
+    for (vulkan_render_target const* const target : targets)
+    {
+        recorded.push_back({target, target->generation()});
+    }
+}
+
+void vkrndr::vulkan_renderer::record_imgui_commands()
+{
+    VkCommandBuffer const command_buffer{
+        imgui_command_buffers_[current_frame_]};
+    begin_secondary_command_buffer(command_buffer,
+        swap_chain_->image_format(),
+        device_->max_msaa_samples());
+
+    ImGui::Render();
+    gpu_profiler_.begin_imgui(command_buffer, current_frame_);
+    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), command_buffer);
+    gpu_profiler_.end_imgui(command_buffer, current_frame_);
+
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"unable to end command buffer recording!"};
+    }
 }
 
 void vkrndr::vulkan_renderer::record_command_buffer(
@@ -232,6 +390,9 @@ void vkrndr::vulkan_renderer::record_command_buffer(
     VkCommandBuffer& command_buffer,
     uint32_t const image_index)
 {
+    record_target_commands(targets);
+    record_imgui_commands();
+
     VkCommandBufferBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
@@ -239,6 +400,8 @@ void vkrndr::vulkan_renderer::record_command_buffer(
         throw std::runtime_error{"unable to begin command buffer recording!"};
     }
 
+    gpu_profiler_.begin_frame(command_buffer, current_frame_);
+
     transition_image(swap_chain_->image(image_index),
         command_buffer,
         VK_IMAGE_LAYOUT_UNDEFINED,
@@ -269,6 +432,7 @@ void vkrndr::vulkan_renderer::record_command_buffer(
 
     VkRenderingInfoKHR render_info{};
     render_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    render_info.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
     render_info.renderArea = {{0, 0}, swap_chain_->extent()};
     render_info.layerCount = 1;
     render_info.colorAttachmentCount = 1;
@@ -276,20 +440,28 @@ void vkrndr::vulkan_renderer::record_command_buffer(
 
     vkCmdBeginRendering(command_buffer, &render_info);
 
-    std::ranges::for_each(targets,
-        [&, this](auto&& o)
-        { o->render(command_buffer, swap_chain_->extent(), current_frame_); });
-
-    ImGui::Render();
-    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), command_buffer);
+    if (!targets.empty())
+    {
+        vkCmdExecuteCommands(command_buffer,
+            1,
+            &target_command_buffers_[current_frame_]);
+    }
+    vkCmdExecuteCommands(command_buffer,
+        1,
+        &imgui_command_buffers_[current_frame_]);
 
     vkCmdEndRendering(command_buffer);
+    gpu_profiler_.end_rendering(command_buffer, current_frame_);
 
     transition_image(swap_chain_->image(image_index),
         command_buffer,
         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
         VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
 
+    gpu_profiler_.end_frame(command_buffer,
+        current_frame_,
+        count_cast(targets.size()));
+
     if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
     {
         throw std::runtime_error{"unable to end command buffer recording!"};
@@ -303,34 +475,61 @@ bool vkrndr::vulkan_renderer::is_multisampled() const
 
 void vkrndr::vulkan_renderer::recreate()
 {
-    if (is_multisampled())
+    // Recorded commands depend on the extent
+    for (auto& recorded : recorded_targets_)
     {
-        cleanup_images();
+        recorded.clear();
+    }
 
-        create_image(device_->physical(),
-            device_->logical(),
-            swap_chain_->extent(),
-            1,
-            device_->max_msaa_samples(),
-            swap_chain_->image_format(),
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
-                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            color_image_,
-            color_image_memory_);
-
-        color_image_view_ = create_image_view(device_->logical(),
-            color_image_,
-            swap_chain_->image_format(),
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            1);
+    // Waits for the device, which only happens when the surface reports
+    // different limits
+    if (imgui_min_image_count_ != 0 &&
+        imgui_min_image_count_ != swap_chain_->min_image_count())
+    {
+        imgui_min_image_count_ = swap_chain_->min_image_count();
+        ImGui_ImplVulkan_SetMinImageCount(imgui_min_image_count_);
+    }
+
+    if (!is_multisampled())
+    {
+        return;
     }
+
+    VkImage image{};
+    memory_allocation memory;
+    create_image(device_,
+        swap_chain_->extent(),
+        1,
+        device_->max_msaa_samples(),
+        swap_chain_->image_format(),
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        image,
+        memory);
+
+    VkImageView const view{create_image_view(device_->logical(),
+        image,
+        swap_chain_->image_format(),
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        1)};
+
+    if (color_image_)
+    {
+        deletion_queue_.push(color_image_view_);
+        deletion_queue_.push(color_image_, color_image_memory_);
+    }
+
+    color_image_ = image;
+    color_image_view_ = view;
+    color_image_memory_ = memory;
 }
 
 void vkrndr::vulkan_renderer::cleanup_images()
 {
     vkDestroyImageView(device_->logical(), color_image_view_, nullptr);
     vkDestroyImage(device_->logical(), color_image_, nullptr);
-    vkFreeMemory(device_->logical(), color_image_memory_, nullptr);
+    device_->allocator()->free(color_image_memory_);
+    color_image_memory_ = {};
 }
@@ -6,15 +6,19 @@
 #include <vulkan_utility.hpp>
 #include <vulkan_window.hpp>
 
+#include <spdlog/spdlog.h>
+
 #include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace
 {
@@ -35,16 +39,31 @@ namespace
         return available_formats.front();
     }
 
+    // FIFO is the only mode every surface has to support
     [[nodiscard]] VkPresentModeKHR choose_swap_present_mode(
-        std::span<VkPresentModeKHR const> available_present_modes)
+        std::span<VkPresentModeKHR const> available_present_modes,
+        VkPresentModeKHR const preferred_mode)
     {
-        constexpr auto preferred_mode{VK_PRESENT_MODE_MAILBOX_KHR};
         return std::ranges::find(available_present_modes, preferred_mode) !=
                 available_present_modes.cend()
             ? preferred_mode
             : VK_PRESENT_MODE_FIFO_KHR;
     }
 
+    [[nodiscard]] uint32_t choose_image_count(
+        VkSurfaceCapabilitiesKHR const& capabilities,
+        std::optional<uint32_t> const requested)
+    {
+        uint32_t rv{requested.value_or(capabilities.minImageCount + 1)};
+        rv = std::max(rv, capabilities.minImageCount);
+        // Zero maximum means there is no limit
+        if (capabilities.maxImageCount > 0)
+        {
+            rv = std::min(rv, capabilities.maxImageCount);
+        }
+        return rv;
+    }
+
     [[nodiscard]] VkSemaphore create_semaphore(
         vkrndr::vulkan_device const* const device)
     {
@@ -62,26 +81,6 @@ namespace
 
         return rv;
     }
-
-    [[nodiscard]] VkFence
-    create_fence(vkrndr::vulkan_device const* const device, bool set_signaled)
-    {
-        VkFenceCreateInfo fence_info{};
-        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        if (set_signaled)
-        {
-            fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-        }
-
-        VkFence rv{};
-        if (vkCreateFence(device->logical(), &fence_info, nullptr, &rv) !=
-            VK_SUCCESS)
-        {
-            throw std::runtime_error{"failed to create fence"};
-        }
-
-        return rv;
-    }
 } // namespace
 
 vkrndr::swap_chain_support
@@ -126,16 +125,24 @@ vkrndr::query_swap_chain_support(VkPhysicalDevice device, VkSurfaceKHR surface)
 
 vkrndr::vulkan_swap_chain::vulkan_swap_chain(vulkan_window* window,
     vulkan_context* context,
-    vulkan_device* device)
+    vulkan_device* device,
+    swap_chain_settings const& settings)
     : window_{window}
     , context_{context}
     , device_{device}
+    , settings_{settings}
 {
-    create_chain_and_images();
-    for (int i{}; i != max_frames_in_flight; ++i)
+    if (settings_.frames_in_flight == 0)
+    {
+        throw std::runtime_error{"at least one frame has to be in flight"};
+    }
+
+    create_chain_and_images(VK_NULL_HANDLE);
+    for (uint32_t i{}; i != settings_.frames_in_flight; ++i)
     {
         image_syncs_.emplace_back(device_);
     }
+    frame_timeline_ = create_timeline_semaphore(device_);
 
     vkGetDeviceQueue(device_->logical(),
         device_->graphics_family(),
@@ -152,12 +159,18 @@ vkrndr::vulkan_swap_chain::vulkan_swap_chain(vulkan_swap_chain&& other) noexcept
     : window_{other.window_}
     , context_{other.context_}
     , device_{std::exchange(other.device_, nullptr)}
+    , settings_{other.settings_}
     , image_format_{other.image_format_}
+    , present_mode_{other.present_mode_}
+    , min_image_count_{other.min_image_count_}
     , extent_{other.extent_}
     , chain_{std::exchange(other.chain_, nullptr)}
     , images_{std::move(other.images_)}
     , image_views_{std::move(other.image_views_)}
+    , retired_chains_{std::move(other.retired_chains_)}
     , image_syncs_{std::move(other.image_syncs_)}
+    , frame_timeline_{std::exchange(other.frame_timeline_, nullptr)}
+    , submitted_frame_{other.submitted_frame_}
     , graphics_queue_{other.graphics_queue_}
     , present_queue_{other.present_queue_}
 {
@@ -167,7 +180,9 @@ vkrndr::vulkan_swap_chain::~vulkan_swap_chain()
 {
     if (device_)
     {
+        wait_for_frame(submitted_frame_);
         image_syncs_.clear();
+        vkDestroySemaphore(device_->logical(), frame_timeline_, nullptr);
         cleanup();
     }
 }
@@ -179,11 +194,8 @@ bool vkrndr::vulkan_swap_chain::acquire_next_image(uint32_t const current_frame,
 
     auto const& sync{image_syncs_[current_frame]};
 
-    vkWaitForFences(device_->logical(),
-        1,
-        &sync.in_flight,
-        VK_TRUE,
-        UINT64_MAX);
+    wait_for_frame(sync.frame);
+    release_retired_chains();
 
     VkResult const result{vkAcquireNextImageKHR(device_->logical(),
         chain_,
@@ -201,37 +213,77 @@ bool vkrndr::vulkan_swap_chain::acquire_next_image(uint32_t const current_frame,
         throw std::runtime_error{"failed to acquire swap chain image"};
     }
 
-    vkResetFences(device_->logical(), 1, &sync.in_flight);
     return true;
 }
 
-void vkrndr::vulkan_swap_chain::submit_command_buffer(
+bool vkrndr::vulkan_swap_chain::is_frame_available(
+    uint32_t const current_frame) const
+{
+    return is_frame_complete(image_syncs_[current_frame].frame);
+}
+
+bool vkrndr::vulkan_swap_chain::is_frame_complete(uint64_t const frame) const
+{
+    return frame == 0 || completed_frame() >= frame;
+}
+
+uint64_t vkrndr::vulkan_swap_chain::completed_frame() const
+{
+    return semaphore_value(device_, frame_timeline_);
+}
+
+void vkrndr::vulkan_swap_chain::wait_for_frame(uint64_t const frame) const
+{
+    if (frame != 0)
+    {
+        wait_semaphore(device_, frame_timeline_, frame);
+    }
+}
+
+uint64_t vkrndr::vulkan_swap_chain::submit_command_buffer(
     VkCommandBuffer const* const command_buffer,
     uint32_t const current_frame,
-    uint32_t const image_index)
+    uint32_t const image_index,
+    VkSemaphore const timeline,
+    uint64_t const timeline_value)
 {
-    auto const& sync{image_syncs_[current_frame]};
-
-    std::array const wait_semaphores{sync.image_available};
-    std::array<VkPipelineStageFlags, 1> const wait_stages{
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    std::array const signal_semaphores{sync.render_finished};
+    auto& sync{image_syncs_[current_frame]};
+    uint64_t const frame{submitted_frame_ + 1};
+
+    std::array const wait_semaphores{sync.image_available, timeline};
+    std::array<VkPipelineStageFlags, 2> const wait_stages{
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+    std::array const signal_semaphores{sync.render_finished, frame_timeline_};
+
+    // Values of binary semaphores are ignored
+    std::array<uint64_t, 2> const wait_values{0, timeline_value};
+    std::array<uint64_t, 2> const signal_values{0, frame};
+    VkTimelineSemaphoreSubmitInfo timeline_info{};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.waitSemaphoreValueCount = timeline ? 2u : 1u;
+    timeline_info.pWaitSemaphoreValues = wait_values.data();
+    timeline_info.signalSemaphoreValueCount = 2;
+    timeline_info.pSignalSemaphoreValues = signal_values.data();
 
     VkSubmitInfo submit_info{};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.waitSemaphoreCount = 1;
+    submit_info.pNext = &timeline_info;
+    submit_info.waitSemaphoreCount = timeline ? 2u : 1u;
     submit_info.pWaitSemaphores = wait_semaphores.data();
     submit_info.pWaitDstStageMask = wait_stages.data();
     submit_info.commandBufferCount = 1;
     submit_info.pCommandBuffers = command_buffer;
-    submit_info.signalSemaphoreCount = 1;
+    submit_info.signalSemaphoreCount = 2;
     submit_info.pSignalSemaphores = signal_semaphores.data();
 
-    if (vkQueueSubmit(graphics_queue_, 1, &submit_info, sync.in_flight) !=
+    if (vkQueueSubmit(graphics_queue_, 1, &submit_info, VK_NULL_HANDLE) !=
         VK_SUCCESS)
     {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
+    submitted_frame_ = frame;
+    sync.frame = frame;
 
     VkPresentInfoKHR present_info{};
     present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -250,12 +302,19 @@ void vkrndr::vulkan_swap_chain::submit_command_buffer(
     {
         throw std::runtime_error{"failed to present swap chain image!"};
     }
+
+    return frame;
 }
 
 void vkrndr::vulkan_swap_chain::recreate()
 {
-    cleanup();
-    create_chain_and_images();
+    // Frames submitted so far may still render to or present the old images
+    retired_chains_.push_back({.chain = std::exchange(chain_, nullptr),
+        .image_views = std::exchange(image_views_, {}),
+        .frame = submitted_frame_});
+    images_.clear();
+
+    create_chain_and_images(retired_chains_.back().chain);
 }
 
 vkrndr::vulkan_swap_chain& vkrndr::vulkan_swap_chain::operator=(
@@ -268,13 +327,18 @@ vkrndr::vulkan_swap_chain& vkrndr::vulkan_swap_chain::operator=(
         swap(window_, other.window_);
         swap(context_, other.context_);
         swap(device_, other.device_);
+        swap(settings_, other.settings_);
         swap(image_format_, other.image_format_);
+        swap(present_mode_, other.present_mode_);
         swap(min_image_count_, other.min_image_count_);
         swap(extent_, other.extent_);
         swap(chain_, other.chain_);
         swap(images_, other.images_);
         swap(image_views_, other.image_views_);
+        swap(retired_chains_, other.retired_chains_);
         swap(image_syncs_, other.image_syncs_);
+        swap(frame_timeline_, other.frame_timeline_);
+        swap(submitted_frame_, other.submitted_frame_);
         swap(graphics_queue_, other.graphics_queue_);
         swap(present_queue_, other.present_queue_);
     }
@@ -282,13 +346,20 @@ vkrndr::vulkan_swap_chain& vkrndr::vulkan_swap_chain::operator=(
     return *this;
 }
 
-void vkrndr::vulkan_swap_chain::create_chain_and_images()
+void vkrndr::vulkan_swap_chain::create_chain_and_images(
+    VkSwapchainKHR const old_chain)
 {
     auto swap_details{
         query_swap_chain_support(device_->physical(), context_->surface())};
 
-    VkPresentModeKHR const present_mode{
-        choose_swap_present_mode(swap_details.present_modes)};
+    present_mode_ = choose_swap_present_mode(swap_details.present_modes,
+        settings_.present_mode);
+    if (present_mode_ != settings_.present_mode)
+    {
+        spdlog::warn("Present mode {} is unsupported, using FIFO",
+            static_cast<int>(settings_.present_mode));
+    }
+
     VkSurfaceFormatKHR const surface_format{
         choose_swap_surface_format(swap_details.surface_formats)};
 
@@ -296,12 +367,8 @@ void vkrndr::vulkan_swap_chain::create_chain_and_images()
     extent_ = window_->swap_extent(swap_details.capabilities);
     min_image_count_ = swap_details.capabilities.minImageCount;
 
-    uint32_t used_image_count{min_image_count_ + 1};
-    if (swap_details.capabilities.maxImageCount > 0)
-    {
-        used_image_count =
-            std::min(swap_details.capabilities.maxImageCount, used_image_count);
-    }
+    uint32_t used_image_count{
+        choose_image_count(swap_details.capabilities, settings_.image_count)};
 
     VkSwapchainCreateInfoKHR create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -314,9 +381,9 @@ void vkrndr::vulkan_swap_chain::create_chain_and_images()
     create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
     create_info.preTransform = swap_details.capabilities.currentTransform;
     create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    create_info.presentMode = present_mode;
+    create_info.presentMode = present_mode_;
     create_info.clipped = VK_TRUE;
-    create_info.oldSwapchain = VK_NULL_HANDLE;
+    create_info.oldSwapchain = old_chain;
 
     std::array const queue_family_indices{device_->graphics_family(),
         device_->present_family()};
@@ -369,14 +436,43 @@ void vkrndr::vulkan_swap_chain::create_chain_and_images()
     }
 }
 
+void vkrndr::vulkan_swap_chain::destroy_chain(VkSwapchainKHR const chain,
+    std::span<VkImageView const> const image_views)
+{
+    for (VkImageView const view : image_views)
+    {
+        vkDestroyImageView(device_->logical(), view, nullptr);
+    }
+
+    vkDestroySwapchainKHR(device_->logical(), chain, nullptr);
+}
+
+void vkrndr::vulkan_swap_chain::release_retired_chains()
+{
+    // Presentation isn't tracked by the timeline, images presented from the
+    // old chain are assumed released once the frame after them rendered
+    std::erase_if(retired_chains_,
+        [this](retired_chain const& old)
+        {
+            if (!is_frame_complete(old.frame + 1))
+            {
+                return false;
+            }
+
+            destroy_chain(old.chain, old.image_views);
+            return true;
+        });
+}
+
 void vkrndr::vulkan_swap_chain::cleanup()
 {
-    for (size_t i{}; i != images_.size(); ++i)
+    for (retired_chain const& old : retired_chains_)
     {
-        vkDestroyImageView(device_->logical(), image_views_[i], nullptr);
+        destroy_chain(old.chain, old.image_views);
     }
+    retired_chains_.clear();
 
-    vkDestroySwapchainKHR(device_->logical(), chain_, nullptr);
+    destroy_chain(chain_, image_views_);
 }
 
 vkrndr::vulkan_swap_chain::image_sync::image_sync(
@@ -384,7 +480,6 @@ vkrndr::vulkan_swap_chain::image_sync::image_sync(
     : device_{device}
     , image_available(create_semaphore(device))
     , render_finished(create_semaphore(device))
-    , in_flight(create_fence(device, true))
 {
 }
 
@@ -392,7 +487,7 @@ vkrndr::vulkan_swap_chain::image_sync::image_sync(image_sync&& other) noexcept
     : device_{std::exchange(other.device_, nullptr)}
     , image_available{std::exchange(other.image_available, nullptr)}
     , render_finished{std::exchange(other.render_finished, nullptr)}
-    , in_flight{std::exchange(other.in_flight, nullptr)}
+    , frame{other.frame}
 {
 }
 
@@ -400,7 +495,6 @@ vkrndr::vulkan_swap_chain::image_sync::~image_sync()
 {
     if (device_)
     {
-        vkDestroyFence(device_->logical(), in_flight, nullptr);
         vkDestroySemaphore(device_->logical(), render_finished, nullptr);
         vkDestroySemaphore(device_->logical(), image_available, nullptr);
     }
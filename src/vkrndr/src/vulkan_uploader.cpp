@@ -0,0 +1,368 @@
+#include <vulkan_uploader.hpp>
+
+#include <vulkan_buffer.hpp>
+#include <vulkan_device.hpp>
+#include <vulkan_utility.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+namespace
+{
+    // Satisfies the offset requirements of buffer to image copies for every
+    // texel size
+    constexpr VkDeviceSize staging_alignment{16};
+
+    [[nodiscard]] constexpr VkDeviceSize align_up(VkDeviceSize const value,
+        VkDeviceSize const alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void transition_image(VkCommandBuffer const command_buffer,
+        VkImage const image,
+        VkImageLayout const old_layout,
+        VkImageLayout const new_layout)
+    {
+        VkImageMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.oldLayout = old_layout;
+        barrier.newLayout = new_layout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1};
+
+        // Consumers on other queues are ordered by the timeline semaphore
+        if (new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+        {
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+            barrier.srcAccessMask = VK_ACCESS_2_NONE;
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        }
+        else
+        {
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+            barrier.dstAccessMask = VK_ACCESS_2_NONE;
+        }
+
+        VkDependencyInfo dependency{};
+        dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependency.imageMemoryBarrierCount = 1;
+        dependency.pImageMemoryBarriers = &barrier;
+
+        vkCmdPipelineBarrier2(command_buffer, &dependency);
+    }
+} // namespace
+
+vkrndr::vulkan_uploader::vulkan_uploader(vulkan_device* const device,
+    VkDeviceSize const staging_size)
+    : device_{device}
+    , staging_size_{staging_size}
+    , queue_families_{device->graphics_family(), device->transfer_family()}
+{
+    vkGetDeviceQueue(device_->logical(),
+        device_->transfer_family(),
+        0,
+        &queue_);
+
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+        VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = device_->transfer_family();
+    if (vkCreateCommandPool(device_->logical(),
+            &pool_info,
+            nullptr,
+            &command_pool_) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"failed to create upload command pool"};
+    }
+
+    try
+    {
+        semaphore_ = create_timeline_semaphore(device_);
+
+        staging_ = vkrndr::create_buffer(device_,
+            staging_size,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        staging_map_ = static_cast<std::byte*>(map_memory(staging_));
+    }
+    catch (...)
+    {
+        vkDestroySemaphore(device_->logical(), semaphore_, nullptr);
+        vkDestroyCommandPool(device_->logical(), command_pool_, nullptr);
+        throw;
+    }
+}
+
+vkrndr::vulkan_uploader::~vulkan_uploader()
+{
+    wait(submitted_value_);
+
+    destroy(device_, &staging_);
+    vkDestroySemaphore(device_->logical(), semaphore_, nullptr);
+    // Command buffers are freed together with their pool
+    vkDestroyCommandPool(device_->logical(), command_pool_, nullptr);
+}
+
+vkrndr::vulkan_buffer vkrndr::vulkan_uploader::create_buffer(
+    VkBufferUsageFlags const usage,
+    std::span<std::byte const> const data)
+{
+    vulkan_buffer rv{vkrndr::create_buffer(device_,
+        data.size(),
+        usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        queue_families())};
+
+    try
+    {
+        upload(rv, 0, data);
+    }
+    catch (...)
+    {
+        destroy(device_, &rv);
+        throw;
+    }
+
+    return rv;
+}
+
+void vkrndr::vulkan_uploader::upload(vulkan_buffer const& destination,
+    VkDeviceSize const offset,
+    std::span<std::byte const> data)
+{
+    // Large uploads are split so that they never need the whole ring
+    VkDeviceSize const max_chunk{staging_size_ / 2};
+
+    VkDeviceSize destination_offset{offset};
+    while (!data.empty())
+    {
+        auto const chunk{data.first(std::min(data.size(), max_chunk))};
+
+        VkBufferCopy const region{.srcOffset = stage(chunk),
+            .dstOffset = destination_offset,
+            .size = chunk.size()};
+        vkCmdCopyBuffer(recording_buffer(),
+            staging_.buffer,
+            destination.buffer,
+            1,
+            &region);
+
+        destination_offset += chunk.size();
+        data = data.subspan(chunk.size());
+    }
+}
+
+void vkrndr::vulkan_uploader::upload(VkImage const image,
+    VkExtent2D const extent,
+    std::span<std::byte const> const data)
+{
+    VkDeviceSize const source_offset{stage(data)};
+    VkCommandBuffer const command_buffer{recording_buffer()};
+
+    transition_image(command_buffer,
+        image,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = source_offset;
+    region.imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .mipLevel = 0,
+        .baseArrayLayer = 0,
+        .layerCount = 1};
+    region.imageExtent = {extent.width, extent.height, 1};
+    vkCmdCopyBufferToImage(command_buffer,
+        staging_.buffer,
+        image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        1,
+        &region);
+
+    transition_image(command_buffer,
+        image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+uint64_t vkrndr::vulkan_uploader::submit()
+{
+    if (!recording_)
+    {
+        return submitted_value_;
+    }
+
+    if (vkEndCommandBuffer(recording_) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"unable to end upload command buffer"};
+    }
+
+    VkCommandBufferSubmitInfo command_buffer_info{};
+    command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    command_buffer_info.commandBuffer = recording_;
+
+    VkSemaphoreSubmitInfo signal_info{};
+    signal_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    signal_info.semaphore = semaphore_;
+    signal_info.value = submitted_value_ + 1;
+    signal_info.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkSubmitInfo2 submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submit_info.commandBufferInfoCount = 1;
+    submit_info.pCommandBufferInfos = &command_buffer_info;
+    submit_info.signalSemaphoreInfoCount = 1;
+    submit_info.pSignalSemaphoreInfos = &signal_info;
+
+    if (vkQueueSubmit2(queue_, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"failed to submit upload command buffer"};
+    }
+
+    ++submitted_value_;
+    in_flight_.push_back({.command_buffer = recording_,
+        .value = submitted_value_,
+        .staging_begin = recording_begin_});
+    recording_ = VK_NULL_HANDLE;
+    recording_begin_ = staging_head_;
+
+    return submitted_value_;
+}
+
+void vkrndr::vulkan_uploader::wait(uint64_t const value) const
+{
+    wait_semaphore(device_, semaphore_, value);
+}
+
+std::span<uint32_t const> vkrndr::vulkan_uploader::queue_families() const
+{
+    return std::span{queue_families_}.first(
+        queue_families_[0] == queue_families_[1] ? size_t{1} : size_t{2});
+}
+
+VkDeviceSize vkrndr::vulkan_uploader::stage(
+    std::span<std::byte const> const data)
+{
+    VkDeviceSize const capacity{staging_size_};
+    if (data.size() > capacity)
+    {
+        throw std::runtime_error{"upload is larger than the staging buffer"};
+    }
+
+    // Staged data of batches not yet completed occupies [tail, head) of the
+    // ring, possibly wrapping around its end
+    for (;;)
+    {
+        retire_completed();
+
+        bool const is_empty{
+            in_flight_.empty() && staging_head_ == recording_begin_};
+        if (is_empty)
+        {
+            staging_head_ = 0;
+            recording_begin_ = 0;
+        }
+
+        VkDeviceSize const tail{in_flight_.empty()
+                ? recording_begin_
+                : in_flight_.front().staging_begin};
+        VkDeviceSize const aligned{align_up(staging_head_, staging_alignment)};
+
+        std::optional<VkDeviceSize> offset;
+        if (is_empty || staging_head_ > tail)
+        {
+            if (aligned + data.size() <= capacity)
+            {
+                offset = aligned;
+            }
+            else if (data.size() < tail)
+            {
+                offset = 0;
+            }
+        }
+        else if (staging_head_ < tail && aligned + data.size() < tail)
+        {
+            offset = aligned;
+        }
+
+        if (offset)
+        {
+            memcpy(staging_map_ + *offset, data.data(), data.size());
+            flush_memory(device_, staging_, *offset, data.size());
+            staging_head_ = *offset + data.size();
+            return *offset;
+        }
+
+        // Wait for the oldest batch to make room
+        submit();
+        wait(in_flight_.front().value);
+    }
+}
+
+VkCommandBuffer vkrndr::vulkan_uploader::recording_buffer()
+{
+    if (recording_)
+    {
+        return recording_;
+    }
+
+    if (free_command_buffers_.empty())
+    {
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = command_pool_;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+
+        VkCommandBuffer command_buffer{};
+        if (vkAllocateCommandBuffers(device_->logical(),
+                &alloc_info,
+                &command_buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"failed to allocate command buffers!"};
+        }
+        free_command_buffers_.push_back(command_buffer);
+    }
+
+    VkCommandBuffer const command_buffer{free_command_buffers_.back()};
+    vkResetCommandBuffer(command_buffer, 0);
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"unable to begin upload command buffer"};
+    }
+
+    free_command_buffers_.pop_back();
+    recording_ = command_buffer;
+    return recording_;
+}
+
+void vkrndr::vulkan_uploader::retire_completed()
+{
+    if (in_flight_.empty())
+    {
+        return;
+    }
+
+    uint64_t const completed{semaphore_value(device_, semaphore_)};
+    while (!in_flight_.empty() && in_flight_.front().value <= completed)
+    {
+        free_command_buffers_.push_back(in_flight_.front().command_buffer);
+        in_flight_.pop_front();
+    }
+}
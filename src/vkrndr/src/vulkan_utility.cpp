@@ -1,5 +1,8 @@
 #include <vulkan_utility.hpp>
 
+#include <vulkan_device.hpp>
+#include <vulkan_memory.hpp>
+
 #include <SDL_error.h>
 #include <SDL_hints.h>
 #include <SDL_stdinc.h>
@@ -25,17 +28,17 @@ uint32_t vkrndr::find_memory_type(VkPhysicalDevice const physical_device,
     throw std::runtime_error{"failed to find suitable memory type!"};
 }
 
-void vkrndr::create_image(VkPhysicalDevice physical_device,
-    VkDevice device,
-    VkExtent2D extent,
-    uint32_t mip_levels,
-    VkSampleCountFlagBits samples,
-    VkFormat format,
-    VkImageTiling tiling,
-    VkImageUsageFlags usage,
-    VkMemoryPropertyFlags properties,
+void vkrndr::create_image(vulkan_device* const device,
+    VkExtent2D const extent,
+    uint32_t const mip_levels,
+    VkSampleCountFlagBits const samples,
+    VkFormat const format,
+    VkImageTiling const tiling,
+    VkImageUsageFlags const usage,
+    VkMemoryPropertyFlags const properties,
     VkImage& image,
-    VkDeviceMemory& image_memory)
+    memory_allocation& image_memory,
+    std::span<uint32_t const> const queue_families)
 {
     VkImageCreateInfo image_info{};
     image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -49,35 +52,50 @@ void vkrndr::create_image(VkPhysicalDevice physical_device,
     image_info.tiling = tiling;
     image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     image_info.usage = usage;
-    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (queue_families.size() > 1)
+    {
+        image_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        image_info.queueFamilyIndexCount = count_cast(queue_families.size());
+        image_info.pQueueFamilyIndices = queue_families.data();
+    }
+    else
+    {
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
     image_info.samples = samples;
     image_info.flags = 0;
 
-    if (vkCreateImage(device, &image_info, nullptr, &image) != VK_SUCCESS)
+    if (vkCreateImage(device->logical(), &image_info, nullptr, &image) !=
+        VK_SUCCESS)
     {
         throw std::runtime_error{"failed to create image!"};
     }
 
     VkMemoryRequirements memory_requirements;
-    vkGetImageMemoryRequirements(device, image, &memory_requirements);
-
-    VkMemoryAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = memory_requirements.size;
-    alloc_info.memoryTypeIndex = vkrndr::find_memory_type(physical_device,
-        memory_requirements.memoryTypeBits,
-        properties);
-    if (vkAllocateMemory(device, &alloc_info, nullptr, &image_memory) !=
-        VK_SUCCESS)
+    vkGetImageMemoryRequirements(device->logical(),
+        image,
+        &memory_requirements);
+
+    try
+    {
+        image_memory = device->allocator()->allocate(memory_requirements,
+            properties,
+            properties,
+            tiling == VK_IMAGE_TILING_LINEAR);
+    }
+    catch (...)
     {
-        vkDestroyImage(device, image, nullptr);
-        throw std::runtime_error{"failed to allocate image memory!"};
+        vkDestroyImage(device->logical(), image, nullptr);
+        throw;
     }
 
-    if (vkBindImageMemory(device, image, image_memory, 0) != VK_SUCCESS)
+    if (vkBindImageMemory(device->logical(),
+            image,
+            image_memory.memory,
+            image_memory.offset) != VK_SUCCESS)
     {
-        vkFreeMemory(device, image_memory, nullptr);
-        vkDestroyImage(device, image, nullptr);
+        device->allocator()->free(image_memory);
+        vkDestroyImage(device->logical(), image, nullptr);
         throw std::runtime_error{"failed to bind image memory!"};
     };
 }
@@ -109,3 +127,57 @@ VkImageView vkrndr::create_image_view(VkDevice device,
 
     return imageView;
 }
+
+VkSemaphore vkrndr::create_timeline_semaphore(
+    vulkan_device const* const device)
+{
+    VkSemaphoreTypeCreateInfo type_info{};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphore_info{};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_info.pNext = &type_info;
+
+    VkSemaphore rv{};
+    if (vkCreateSemaphore(device->logical(), &semaphore_info, nullptr, &rv) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error{"failed to create timeline semaphore"};
+    }
+
+    return rv;
+}
+
+uint64_t vkrndr::semaphore_value(vulkan_device const* const device,
+    VkSemaphore const timeline)
+{
+    uint64_t rv{};
+    if (vkGetSemaphoreCounterValue(device->logical(), timeline, &rv) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error{"failed to query timeline semaphore"};
+    }
+    return rv;
+}
+
+bool vkrndr::wait_semaphore(vulkan_device const* const device,
+    VkSemaphore const timeline,
+    uint64_t const value,
+    uint64_t const timeout)
+{
+    VkSemaphoreWaitInfo wait_info{};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &timeline;
+    wait_info.pValues = &value;
+
+    VkResult const result{
+        vkWaitSemaphores(device->logical(), &wait_info, timeout)};
+    if (result != VK_SUCCESS && result != VK_TIMEOUT)
+    {
+        throw std::runtime_error{"failed to wait for timeline semaphore"};
+    }
+    return result == VK_SUCCESS;
+}
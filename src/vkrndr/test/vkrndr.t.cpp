@@ -0,0 +1,103 @@
+#include <range_allocator.hpp>
+#include <vulkan_deletion_queue.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+
+TEST_CASE("range allocator splits free ranges around allocations",
+    "[range_allocator]")
+{
+    vkrndr::range_allocator allocator{256};
+
+    CHECK(allocator.allocate(16, 1) == 0);
+    CHECK(allocator.free_ranges() ==
+        std::vector<vkrndr::free_range>{{.offset = 16, .size = 240}});
+
+    // Padding in front of an aligned allocation stays free
+    CHECK(allocator.allocate(32, 64) == 64);
+    CHECK(allocator.free_ranges() ==
+        std::vector<vkrndr::free_range>{{.offset = 16, .size = 48},
+            {.offset = 96, .size = 160}});
+
+    CHECK(allocator.allocate(48, 16) == 16);
+    CHECK(allocator.free_ranges() ==
+        std::vector<vkrndr::free_range>{{.offset = 96, .size = 160}});
+
+    CHECK_FALSE(allocator.allocate(161, 1).has_value());
+    CHECK(allocator.allocate(160, 32) == 96);
+    CHECK(allocator.free_ranges().empty());
+}
+
+TEST_CASE("range allocator merges freed ranges with their neighbours",
+    "[range_allocator]")
+{
+    vkrndr::range_allocator allocator{256};
+    auto const first{allocator.allocate(32, 1)};
+    auto const second{allocator.allocate(32, 1)};
+    auto const third{allocator.allocate(32, 1)};
+    REQUIRE(first == 0);
+    REQUIRE(second == 32);
+    REQUIRE(third == 64);
+
+    allocator.free(*second, 32);
+    CHECK(allocator.free_ranges() ==
+        std::vector<vkrndr::free_range>{{.offset = 32, .size = 32},
+            {.offset = 96, .size = 160}});
+
+    allocator.free(*first, 32);
+    CHECK(allocator.free_ranges() ==
+        std::vector<vkrndr::free_range>{{.offset = 0, .size = 64},
+            {.offset = 96, .size = 160}});
+
+    allocator.free(*third, 32);
+    CHECK(allocator.free_ranges() ==
+        std::vector<vkrndr::free_range>{{.offset = 0, .size = 256}});
+}
+
+TEST_CASE("deletion queue releases objects of completed frames in order",
+    "[deletion_queue]")
+{
+    std::vector<int> destroyed;
+    vkrndr::vulkan_deletion_queue queue{nullptr};
+    auto const push = [&queue, &destroyed](int const id)
+    { queue.defer([&destroyed, id]() { destroyed.push_back(id); }); };
+
+    push(0);
+    queue.frame_submitted(1);
+    push(1);
+    push(2);
+    queue.frame_submitted(3);
+    push(3);
+    REQUIRE(queue.size() == 4);
+
+    queue.release(0);
+    CHECK(destroyed == std::vector{0});
+
+    // Objects pushed after frame 1 was submitted only wait for frame 1
+    queue.release(2);
+    CHECK(destroyed == std::vector{0, 1, 2});
+
+    queue.release(2);
+    CHECK(queue.size() == 1);
+
+    queue.release(3);
+    CHECK(destroyed == std::vector{0, 1, 2, 3});
+    CHECK(queue.size() == 0);
+}
+
+TEST_CASE("deletion queue destroys remaining objects with it",
+    "[deletion_queue]")
+{
+    int destroyed{};
+    {
+        vkrndr::vulkan_deletion_queue queue{nullptr};
+        queue.frame_submitted(5);
+        queue.defer([&destroyed]() { ++destroyed; });
+        queue.defer([&destroyed]() { ++destroyed; });
+
+        queue.release(4);
+        CHECK(destroyed == 0);
+    }
+    CHECK(destroyed == 2);
+}